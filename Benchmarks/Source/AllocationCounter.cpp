@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    AllocationCounter.cpp
+    Created: 17 Oct 2026 10:02:14pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<juce::int64> numAllocations { 0 };
+    thread_local bool isCounting = false;
+
+    void* allocate(std::size_t size)
+    {
+        if (isCounting)
+        {
+            numAllocations.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (void* memory = std::malloc(size > 0 ? size : 1))
+        {
+            return memory;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+AllocationCounter::ScopedCount::ScopedCount() noexcept :
+    m_wasCounting(isCounting)
+{
+    isCounting = true;
+}
+
+AllocationCounter::ScopedCount::~ScopedCount() noexcept
+{
+    isCounting = m_wasCounting;
+}
+
+juce::int64 AllocationCounter::getNumAllocations() noexcept
+{
+    return numAllocations.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+// replaces the global allocation functions for the whole benchmark executable
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    AllocationCounter.h
+    Created: 17 Oct 2026 10:02:14pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Counts heap allocations made through operator new, which the benchmarks replace.
+ *
+ * Only allocations on a thread inside a ScopedCount are counted, so the synth's
+ * background threads don't show up in what the audio thread is charged with.
+ */
+class AllocationCounter
+{
+    public:
+        /** Counts the calling thread's allocations while it exists */
+        class ScopedCount
+        {
+            public:
+                ScopedCount() noexcept;
+                ~ScopedCount() noexcept;
+
+            private:
+                bool m_wasCounting;
+        };
+
+        /** Returns the number of allocations counted so far */
+        static juce::int64 getNumAllocations() noexcept;
+};
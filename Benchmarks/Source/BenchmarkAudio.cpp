@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    BenchmarkAudio.cpp
+    Created: 17 Oct 2026 10:02:14pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "BenchmarkAudio.h"
+
+BenchmarkAudio BenchmarkAudio::createSyntheticLoop(double sampleRate, double bpm)
+{
+    BenchmarkAudio audio;
+    audio.sampleRate = sampleRate;
+    audio.bpm = bpm;
+
+    const int samplesPerBeat = juce::roundToInt(sampleRate * 60.0 / bpm);
+    audio.buffer.setSize(2, samplesPerBeat * 4 * numSyntheticBars);
+    juce::Random random(1);
+
+    for (int i = 0; i < audio.buffer.getNumSamples(); ++i)
+    {
+        const int beatPosition = i % samplesPerBeat;
+        const auto envelope = (float) std::exp(-8.0 * beatPosition / samplesPerBeat);
+        const auto tone = (float) std::sin(juce::MathConstants<double>::twoPi * 110.0 * i / sampleRate);
+        audio.buffer.setSample(0, i, envelope * tone);
+        audio.buffer.setSample(1, i, envelope * (tone + 0.1f * random.nextFloat()));
+    }
+    return audio;
+}
+
+bool BenchmarkAudio::loadFile(const juce::File& file, double bpm, BenchmarkAudio& result)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr)
+    {
+        return false;
+    }
+
+    result.sampleRate = reader->sampleRate;
+    result.bpm = bpm;
+    result.buffer.setSize((int) juce::jmin(2u, reader->numChannels), (int) reader->lengthInSamples);
+    reader->read(&result.buffer, 0, result.buffer.getNumSamples(), 0, true, true);
+    return true;
+}
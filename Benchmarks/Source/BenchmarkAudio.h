@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    BenchmarkAudio.h
+    Created: 17 Oct 2026 10:02:14pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * The audio the benchmarks load into the synth: a synthetic loop, or a WAV file
+ */
+struct BenchmarkAudio
+{
+    juce::AudioBuffer<float> buffer;
+    double sampleRate = 48000;
+    double bpm = 120;
+
+    /** Number of bars in a synthetic loop, and so of LOOP MODE slices */
+    static constexpr int numSyntheticBars = 8;
+
+    /** A stereo loop with a decaying tone on every beat, the same every time */
+    static BenchmarkAudio createSyntheticLoop(double sampleRate = 48000, double bpm = 120);
+
+    /**
+     * Decodes a WAV file (or anything else the basic formats read)
+     * @return false if the file couldn't be read
+     */
+    static bool loadFile(const juce::File& file, double bpm, BenchmarkAudio& result);
+};
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    EngineBenchmark.cpp
+    Created: 17 Oct 2026 10:02:14pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "EngineBenchmark.h"
+#include "AllocationCounter.h"
+#include "../../Source/TwoShotSynth.h"
+
+namespace
+{
+    // the synth's first LOOP MODE slice, and the note SAMPLE MODE plays at its own pitch
+    constexpr int firstNote = 64;
+    constexpr double retriggerSeconds = 0.5;
+    constexpr double tempoChangeSeconds = 2.0;
+    constexpr double tempoScript[] = { 1.0, 1.05, 0.95 };
+}
+
+void EngineBenchmark::run(const Options& options)
+{
+    if (options.writeCsv)
+    {
+        std::cout << "mode,block_size,voices,ns_per_sample,ns_per_voice_sample,allocations" << std::endl;
+    }
+    else
+    {
+        std::cout << "Engine cost, " << options.secondsPerRun << "s of audio per run, "
+                  << options.numRenderThreads << " render threads" << std::endl;
+        std::cout << "mode    block  voices    ns/sample  ns/voice/sample  allocations" << std::endl;
+    }
+
+    for (const bool isLoop : { false, true })
+    {
+        const juce::String mode = isLoop ? "loop" : "sample";
+
+        for (const int blockSize : options.blockSizes)
+        {
+            for (const int numVoices : options.voiceCounts)
+            {
+                const auto result = measure(options, isLoop, blockSize, numVoices);
+                const double nanosPerVoice = result.nanosPerSample / numVoices;
+
+                if (options.writeCsv)
+                {
+                    std::cout << mode << "," << blockSize << "," << numVoices << ","
+                              << juce::String(result.nanosPerSample, 2) << ","
+                              << juce::String(nanosPerVoice, 2) << ","
+                              << result.numAllocations << std::endl;
+                }
+                else
+                {
+                    std::cout << mode.paddedRight(' ', 6)
+                              << juce::String(blockSize).paddedLeft(' ', 7)
+                              << juce::String(numVoices).paddedLeft(' ', 8)
+                              << juce::String(result.nanosPerSample, 2).paddedLeft(' ', 13)
+                              << juce::String(nanosPerVoice, 2).paddedLeft(' ', 17)
+                              << juce::String(result.numAllocations).paddedLeft(' ', 13) << std::endl;
+                }
+            }
+        }
+    }
+}
+
+EngineBenchmark::Result EngineBenchmark::measure(const Options& options, bool isLoop, int blockSize, int numVoices)
+{
+    const auto& audio = options.audio;
+
+    TwoShotSynth synth;
+    synth.setHostSampleRate(options.hostSampleRate);
+    synth.setPolyphony(numVoices);
+    synth.setRenderThreads(options.numRenderThreads);
+
+    juce::AudioBuffer<float> source(audio.buffer);
+    synth.setAudio(std::move(source), audio.sampleRate, isLoop ? std::optional<const double>(audio.bpm) : std::nullopt);
+
+    // in LOOP MODE each note plays one bar, so voices beyond the number of bars
+    // play the same bars on other midi channels
+    const int samplesPerBar = juce::roundToInt(audio.sampleRate * 240.0 / audio.bpm);
+    const int numNotes = isLoop ? juce::jlimit(1, 8, audio.buffer.getNumSamples() / samplesPerBar) : 32;
+
+    juce::AudioBuffer<float> output(2, blockSize);
+    juce::MidiBuffer midi;
+    midi.ensureSize((size_t) numVoices * 8);
+
+    const int numBlocks = juce::jmax(1, juce::roundToInt(options.secondsPerRun * options.hostSampleRate / blockSize));
+    const int blocksPerRetrigger = juce::jmax(1, juce::roundToInt(retriggerSeconds * options.hostSampleRate / blockSize));
+    const int blocksPerTempoChange = juce::jmax(1, juce::roundToInt(tempoChangeSeconds * options.hostSampleRate / blockSize));
+
+    juce::int64 ticks = 0;
+    juce::int64 numAllocations = 0;
+
+    // the first block installs the sounds, and isn't measured
+    for (int block = -1; block < numBlocks; ++block)
+    {
+        midi.clear();
+        if (block >= 0 && block % blocksPerRetrigger == 0)
+        {
+            for (int voice = 0; voice < numVoices; ++voice)
+            {
+                const int channel = 1 + (voice / numNotes) % 16;
+                midi.addEvent(juce::MidiMessage::noteOn(channel, firstNote + voice % numNotes, 0.8f), 0);
+            }
+        }
+
+        const double tempo = tempoScript[(juce::jmax(0, block) / blocksPerTempoChange) % juce::numElementsInArray(tempoScript)];
+        output.clear();
+
+        const auto allocationsBefore = AllocationCounter::getNumAllocations();
+        const auto start = juce::Time::getHighResolutionTicks();
+        {
+            const AllocationCounter::ScopedCount count;
+            synth.processNextBlock(output, midi, audio.bpm * tempo);
+        }
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+        if (block >= 0)
+        {
+            ticks += elapsed;
+            numAllocations += AllocationCounter::getNumAllocations() - allocationsBefore;
+        }
+    }
+
+    const double seconds = juce::Time::highResolutionTicksToSeconds(ticks);
+    return { seconds * 1.0e9 / ((double) numBlocks * blockSize), numAllocations };
+}
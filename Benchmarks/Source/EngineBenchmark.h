@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    EngineBenchmark.h
+    Created: 17 Oct 2026 10:02:14pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BenchmarkAudio.h"
+
+/**
+ * Measures what the whole synth costs, in SAMPLE MODE and LOOP MODE, across block sizes
+ * and numbers of voices.
+ *
+ * For every combination a fresh TwoShotSynth is loaded through setAudio(), and then driven
+ * through processNextBlock() by a script: every voice is retriggered twice a second, and
+ * the host tempo moves between the loop's own and 5% either side of it every two seconds.
+ * Only the time spent in processNextBlock() is measured, and only allocations made on the
+ * calling thread are counted, so the synth's background threads don't show up.
+ */
+class EngineBenchmark
+{
+    public:
+        struct Options
+        {
+            BenchmarkAudio audio = BenchmarkAudio::createSyntheticLoop();
+            double hostSampleRate = 48000;
+            double secondsPerRun = 1.0;
+            juce::Array<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+            juce::Array<int> voiceCounts { 1, 2, 4, 8, 16, 32, 64, 128 };
+            /** worker threads the voices are shared out with, none renders them all on the calling thread */
+            int numRenderThreads = 0;
+            bool writeCsv = false;
+        };
+
+        /** Runs every combination and prints a row for each */
+        static void run(const Options& options);
+
+    private:
+        struct Result
+        {
+            double nanosPerSample;
+            juce::int64 numAllocations;
+        };
+
+        static Result measure(const Options& options, bool isLoop, int blockSize, int numVoices);
+};
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    EventDensityBenchmark.cpp
+    Created: 17 Oct 2026 9:34:50pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "EventDensityBenchmark.h"
+#include "BenchmarkAudio.h"
+#include "../../Source/TwoShotSynth.h"
+
+namespace
+{
+    constexpr int firstNote = 64;
+}
+
+bool EventDensityBenchmark::run(int blockSize, int numBlocks)
+{
+    const bool noteOffsStop = checkReversedNoteOffs(blockSize);
+    std::cout << "Reversed loop note-offs: " << (noteOffsStop ? "stop their voices" : "LEFT PLAYING") << std::endl;
+
+    std::cout << "Midi event density, " << blockSize << " sample blocks, LOOP MODE" << std::endl;
+    std::cout << "events/block    ns/block    ns/sample    extra ns/event" << std::endl;
+
+    double oneEventNanos = 0;
+    for (const int numEvents : { 1, 2, 4, 8, 16, 32, 64 })
+    {
+        const double nanos = timeBlocks(numEvents, blockSize, numBlocks);
+        if (numEvents == 1)
+        {
+            oneEventNanos = nanos;
+        }
+
+        // every voice is busy at every density, so what a block costs beyond one
+        // event is down to handling the events and splitting the block at them
+        const double extraPerEvent = numEvents > 1 ? (nanos - oneEventNanos) / (numEvents - 1) : 0.0;
+
+        std::cout << juce::String(numEvents).paddedLeft(' ', 12)
+                  << juce::String(nanos, 0).paddedLeft(' ', 12)
+                  << juce::String(nanos / blockSize, 2).paddedLeft(' ', 13)
+                  << juce::String(extraPerEvent, 1).paddedLeft(' ', 18) << std::endl;
+    }
+    return noteOffsStop;
+}
+
+/**
+* Plays each note of a reversed loop, one at a time, and lets it go well before its slice
+* ends, so the only thing that can stop its voice is the note-off
+*/
+bool EventDensityBenchmark::checkReversedNoteOffs(int blockSize)
+{
+    auto loop = BenchmarkAudio::createSyntheticLoop();
+    const double loopBpm = loop.bpm;
+    // a tenth of a second is well inside a bar, and half a second is long enough for the release
+    const int numBlocksHeld = juce::roundToInt(0.1 * loop.sampleRate / blockSize);
+    const int numBlocksReleasing = juce::roundToInt(0.5 * loop.sampleRate / blockSize);
+
+    TwoShotSynth synth;
+    synth.setHostSampleRate(loop.sampleRate);
+    synth.setAudio(std::move(loop.buffer), loop.sampleRate, loopBpm);
+    synth.setReverse(true);
+
+    juce::AudioBuffer<float> output(2, blockSize);
+    juce::MidiBuffer midi;
+
+    auto processBlocks = [&] (int numBlocks)
+    {
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            output.clear();
+            synth.processNextBlock(output, midi, loopBpm);
+            midi.clear();
+        }
+    };
+
+    // the sounds are picked up by the first block
+    processBlocks(1);
+
+    for (int bar = 0; bar < BenchmarkAudio::numSyntheticBars; ++bar)
+    {
+        midi.addEvent(juce::MidiMessage::noteOn(1, firstNote + bar, 0.8f), 0);
+        processBlocks(numBlocksHeld);
+        if (synth.getNumPlayingVoices() != 1)
+        {
+            return false;
+        }
+
+        midi.addEvent(juce::MidiMessage::noteOff(1, firstNote + bar), 0);
+        processBlocks(numBlocksReleasing);
+        if (synth.getNumPlayingVoices() != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+* Returns the average time, in nanoseconds, the synth takes over a block with this many note-ons
+*/
+double EventDensityBenchmark::timeBlocks(int numEventsPerBlock, int blockSize, int numBlocks)
+{
+    auto loop = BenchmarkAudio::createSyntheticLoop();
+    const double loopBpm = loop.bpm;
+
+    TwoShotSynth synth;
+    synth.setHostSampleRate(loop.sampleRate);
+    synth.setAudio(std::move(loop.buffer), loop.sampleRate, loopBpm);
+
+    juce::AudioBuffer<float> output(2, blockSize);
+    juce::MidiBuffer midi;
+    int note = 0;
+
+    auto processBlock = [&]
+    {
+        midi.clear();
+        for (int event = 0; event < numEventsPerBlock; ++event)
+        {
+            const auto message = juce::MidiMessage::noteOn(1, firstNote + note, 0.8f);
+            midi.addEvent(message, event * blockSize / numEventsPerBlock);
+            note = (note + 1) % BenchmarkAudio::numSyntheticBars;
+        }
+
+        output.clear();
+        // at the loop's own tempo, so the stretch cache stays idle
+        synth.processNextBlock(output, midi, loopBpm);
+    };
+
+    // enough blocks for the sounds to be installed and every voice to be playing
+    for (int block = 0; block < 200; ++block)
+    {
+        processBlock();
+    }
+
+    const auto start = juce::Time::getHighResolutionTicks();
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        processBlock();
+    }
+    const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+    return juce::Time::highResolutionTicksToSeconds(elapsed) * 1.0e9 / numBlocks;
+}
@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    EventDensityBenchmark.h
+    Created: 17 Oct 2026 9:34:50pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Measures what the synth's midi event scheduling costs as events get denser.
+ *
+ * A LOOP MODE synth is driven with blocks holding from 1 to 64 evenly spaced note-ons,
+ * the way dense loop chops arrive from the host, and the time per block and per event
+ * is printed for each density.
+ *
+ * Before that, it checks that note-offs still stop their voices when the loop is reversed,
+ * and each note plays a slice from the other end of the keyboard.
+ */
+class EventDensityBenchmark
+{
+    public:
+        /**
+         * Runs the benchmark and prints a table of results
+         * @return false if a reversed loop's note-off left its voice playing
+         */
+        static bool run(int blockSize = 512, int numBlocks = 4000);
+
+    private:
+        static bool checkReversedNoteOffs(int blockSize);
+        static double timeBlocks(int numEventsPerBlock, int blockSize, int numBlocks);
+};
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 9:34:50pm
+    Author:  Deuel Lab
+
+    Runs the TwoShot engine benchmarks headless, without a host or a plugin.
+
+    Usage: TwoShotBenchmarks [--benchmark engine|events|tempo|kernels|all] [--wav file --bpm 120]
+                             [--seconds 1] [--block-sizes 16,256] [--voices 1,16] [--threads 0] [--csv]
+                             [--kernel-calls 200000]
+
+    Exits with 1 if a SIMD kernel's results don't match the reference version's, or a
+    reversed loop's note-off leaves its voice playing.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "EngineBenchmark.h"
+#include "EventDensityBenchmark.h"
+#include "StretchKernelBenchmark.h"
+#include "TempoDetectionBenchmark.h"
+
+namespace
+{
+    juce::Array<int> parseIntegers(const juce::String& list)
+    {
+        juce::Array<int> values;
+        for (const auto& token : juce::StringArray::fromTokens(list, ",", ""))
+        {
+            values.add(token.trim().getIntValue());
+        }
+        return values;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const juce::ArgumentList args(argc, argv);
+    const juce::String benchmark = args.containsOption("--benchmark") ? args.getValueForOption("--benchmark") : "all";
+
+    EngineBenchmark::Options options;
+
+    if (args.containsOption("--wav"))
+    {
+        const juce::File file(juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--wav")));
+        const double bpm = args.containsOption("--bpm") ? args.getValueForOption("--bpm").getDoubleValue() : 120.0;
+
+        if (! BenchmarkAudio::loadFile(file, bpm, options.audio))
+        {
+            std::cerr << "Couldn't read " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    if (args.containsOption("--seconds"))
+    {
+        options.secondsPerRun = args.getValueForOption("--seconds").getDoubleValue();
+    }
+    if (args.containsOption("--block-sizes"))
+    {
+        options.blockSizes = parseIntegers(args.getValueForOption("--block-sizes"));
+    }
+    if (args.containsOption("--voices"))
+    {
+        options.voiceCounts = parseIntegers(args.getValueForOption("--voices"));
+    }
+    if (args.containsOption("--threads"))
+    {
+        options.numRenderThreads = args.getValueForOption("--threads").getIntValue();
+    }
+    options.writeCsv = args.containsOption("--csv");
+
+    // every benchmark still runs after one fails its checks
+    bool allPassed = true;
+
+    if (benchmark == "engine" || benchmark == "all")
+    {
+        EngineBenchmark::run(options);
+    }
+    if (benchmark == "events" || benchmark == "all")
+    {
+        allPassed = EventDensityBenchmark::run() && allPassed;
+    }
+    if (benchmark == "tempo" || benchmark == "all")
+    {
+        TempoDetectionBenchmark::run();
+    }
+    if (benchmark == "kernels" || benchmark == "all")
+    {
+        const int numCalls = args.containsOption("--kernel-calls") ? args.getValueForOption("--kernel-calls").getIntValue() : 200000;
+        allPassed = StretchKernelBenchmark::run(juce::jmax(1, numCalls)) && allPassed;
+    }
+    return allPassed ? 0 : 1;
+}
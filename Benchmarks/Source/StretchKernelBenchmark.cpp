@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+    StretchKernelBenchmark.cpp
+    Created: 18 Oct 2026 2:14:51am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "StretchKernelBenchmark.h"
+#include <ea_soundtouch/source/SoundTouch/cpu_detect.h>
+
+namespace
+{
+    constexpr int sampleRate = 48000;
+    constexpr int numPositions = 4096;
+
+    /** Exposes the kernels of one of TDStretch's versions */
+    template <typename Stretch>
+    struct Kernels : public Stretch
+    {
+        explicit Kernels(int numChannels)
+        {
+            this->setChannels(numChannels);
+            // the default sequence, seek and overlap lengths, as the stretch cache uses
+            this->setParameters(sampleRate);
+        }
+
+        int getOverlapLength() const { return this->overlapLength; }
+        float* getMidBuffer() { return this->pMidBuffer; }
+
+        double correlate(const float* mixingPos, double& norm) { return this->calcCrossCorr(mixingPos, this->pMidBuffer, norm); }
+
+        void overlap(float* output, const float* input) const
+        {
+            if (this->channels == 1)
+            {
+                this->overlapMono(output, input);
+            }
+            else if (this->channels == 2)
+            {
+                this->overlapStereo(output, input);
+            }
+            else
+            {
+                this->overlapMulti(output, input);
+            }
+        }
+    };
+
+    struct Result
+    {
+        double correlateNanos = 0;
+        double overlapNanos = 0;
+        std::vector<double> correlations;
+        std::vector<float> overlapped;
+    };
+
+    /**
+    * Times both kernels, and keeps what they worked out to compare with the other versions
+    */
+    template <typename Stretch>
+    Result timeKernels(const std::vector<float>& input, int numChannels, int numCalls)
+    {
+        Kernels<Stretch> kernels(numChannels);
+        const int numOverlapSamples = kernels.getOverlapLength() * numChannels;
+        std::copy(input.end() - numOverlapSamples, input.end(), kernels.getMidBuffer());
+
+        Result result;
+        double norm = 0;
+
+        // every position an overlap search would try, one sample frame apart
+        for (int position = 0; position < numPositions; ++position)
+        {
+            result.correlations.push_back(kernels.correlate(input.data() + position * numChannels, norm));
+        }
+
+        double sum = 0;
+        auto start = juce::Time::getHighResolutionTicks();
+        for (int call = 0; call < numCalls; ++call)
+        {
+            sum += kernels.correlate(input.data() + (call % numPositions) * numChannels, norm);
+        }
+        result.correlateNanos = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e9 / numCalls;
+
+        result.overlapped.resize((size_t) numOverlapSamples);
+        const int numOverlapCalls = numCalls / 10;
+        start = juce::Time::getHighResolutionTicks();
+        for (int call = 0; call < numOverlapCalls; ++call)
+        {
+            kernels.overlap(result.overlapped.data(), input.data() + (call % numPositions) * numChannels);
+        }
+        result.overlapNanos = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1.0e9 / numOverlapCalls;
+
+        kernels.overlap(result.overlapped.data(), input.data());
+
+        // so the timed loop isn't optimised away
+        if (sum == 0.123)
+        {
+            std::cout << sum;
+        }
+        return result;
+    }
+
+    /**
+    * Returns the largest difference between two versions' results, relative to the largest result
+    */
+    template <typename Value>
+    double getMaxDifference(const std::vector<Value>& values, const std::vector<Value>& reference)
+    {
+        double maxDifference = 0;
+        double maxReference = 1.0e-9;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            // positions the SIMD versions skip for being unaligned are marked with -1e50
+            if (reference[i] < -1.0e40 || values[i] < -1.0e40)
+            {
+                continue;
+            }
+            maxDifference = juce::jmax(maxDifference, (double) std::abs(values[i] - reference[i]));
+            maxReference = juce::jmax(maxReference, (double) std::abs(reference[i]));
+        }
+        return maxDifference / maxReference;
+    }
+}
+
+bool StretchKernelBenchmark::run(int numCalls)
+{
+    const uint extensions = detectCPUextensions();
+    bool allMatch = true;
+
+    std::cout << "Time-stretch kernels, " << numCalls << " correlations and " << numCalls / 10 << " overlaps" << std::endl;
+    std::cout << "channels  version    ns/correlation    ns/overlap    speedup    difference" << std::endl;
+
+    for (const int numChannels : { 1, 2, 6 })
+    {
+        std::vector<float> input((size_t) ((numPositions + sampleRate / 10) * numChannels));
+        juce::Random random(numChannels);
+        for (auto& sample : input)
+        {
+            sample = random.nextFloat() * 2.0f - 1.0f;
+        }
+
+        std::vector<std::pair<juce::String, Result>> results;
+        results.push_back({ "C++", timeKernels<soundtouch::TDStretch>(input, numChannels, numCalls) });
+       #ifdef SOUNDTOUCH_ALLOW_SSE
+        results.push_back({ "SSE", timeKernels<soundtouch::TDStretchSSE>(input, numChannels, numCalls) });
+       #endif
+       #ifdef SOUNDTOUCH_ALLOW_AVX
+        if (extensions & SUPPORT_AVX2)
+        {
+            results.push_back({ "AVX2", timeKernels<soundtouch::TDStretchAVX2>(input, numChannels, numCalls) });
+        }
+        if (extensions & SUPPORT_AVX512)
+        {
+            results.push_back({ "AVX-512", timeKernels<soundtouch::TDStretchAVX512>(input, numChannels, numCalls) });
+        }
+       #endif
+
+        // the SIMD versions are compared with SSE, which skips the same positions
+        const auto& reference = results.size() > 1 ? results[1].second : results[0].second;
+
+        for (const auto& [name, result] : results)
+        {
+            const double difference = juce::jmax(getMaxDifference(result.correlations, reference.correlations),
+                                                 getMaxDifference(result.overlapped, reference.overlapped));
+
+            std::cout << juce::String(numChannels).paddedLeft(' ', 8) << "  " << name.paddedRight(' ', 7)
+                      << juce::String(result.correlateNanos, 1).paddedLeft(' ', 18)
+                      << juce::String(result.overlapNanos, 1).paddedLeft(' ', 14)
+                      << juce::String(reference.correlateNanos / result.correlateNanos, 2).paddedLeft(' ', 11)
+                      << juce::String(difference, 9).paddedLeft(' ', 14)
+                      << (difference > maxDifference ? "  MISMATCH" : "") << std::endl;
+
+            allMatch = allMatch && difference <= maxDifference;
+        }
+    }
+    juce::ignoreUnused(extensions);
+    return allMatch;
+}
@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    StretchKernelBenchmark.h
+    Created: 18 Oct 2026 2:14:51am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Measures SoundTouch's time-stretch kernels one at a time, for every instruction set
+ * this CPU has.
+ *
+ * The cross-correlation is what the overlap search spends nearly all its time in, and the
+ * overlap mixes each new sequence in. Each kernel is timed in its C++, SSE, AVX2 and
+ * AVX-512 versions, and its results are checked against the SSE version's.
+ */
+class StretchKernelBenchmark
+{
+    public:
+        /**
+         * Runs the benchmark and prints a table of results
+         * @return false if any version's results differ from the reference's by more than maxDifference
+         */
+        static bool run(int numCalls = 200000);
+
+        /** How far a version's results may stray from the reference's, relative to the largest of them */
+        static constexpr double maxDifference = 1.0e-4;
+};
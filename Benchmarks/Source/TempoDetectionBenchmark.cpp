@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    TempoDetectionBenchmark.cpp
+    Created: 18 Oct 2026 1:36:22am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TempoDetectionBenchmark.h"
+#include "BenchmarkAudio.h"
+#include "../../Source/TwoShotTempoDetector.h"
+
+namespace
+{
+    constexpr double loopBpm = 124;
+    constexpr int blockSize = 4096;
+}
+
+void TempoDetectionBenchmark::run(int numFiles, int numRuns)
+{
+    const auto loop = BenchmarkAudio::createSyntheticLoop(48000, loopBpm);
+
+    // as much audio as the detector ever listens to, made by repeating the loop
+    const int numSamples = (int) (TwoShotTempoDetector::maxAnalysisSeconds * loop.sampleRate);
+    juce::AudioBuffer<float> mono(1, numSamples);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        mono.setSample(0, i, loop.buffer.getSample(0, i % loop.buffer.getNumSamples()));
+    }
+
+    std::cout << "Tempo detection, " << TwoShotTempoDetector::maxAnalysisSeconds << " s of a "
+              << loopBpm << " BPM loop" << std::endl;
+    std::cout << "detector        ms/file    speedup    bpm" << std::endl;
+
+    double scalarBpm = 0;
+    double simdBpm = 0;
+    const double scalarMs = timeDetector(false, mono, loop.sampleRate, numRuns, scalarBpm);
+    const double simdMs = timeDetector(true, mono, loop.sampleRate, numRuns, simdBpm);
+
+    std::cout << "scalar  " << juce::String(scalarMs, 2).paddedLeft(' ', 14)
+              << juce::String(1.0, 2).paddedLeft(' ', 11)
+              << juce::String(scalarBpm, 3).paddedLeft(' ', 9) << std::endl;
+    std::cout << "simd    " << juce::String(simdMs, 2).paddedLeft(' ', 14)
+              << juce::String(scalarMs / simdMs, 2).paddedLeft(' ', 11)
+              << juce::String(simdBpm, 3).paddedLeft(' ', 9) << std::endl;
+
+    if (std::abs(scalarBpm - simdBpm) > 0.01)
+    {
+        std::cout << "MISMATCH: the detectors found different tempos" << std::endl;
+    }
+
+    // a folder of loops, written to disk so they are decoded as they would be on import
+    const auto folder = juce::File::createTempFile("TwoShotTempoBenchmark");
+    folder.createDirectory();
+
+    juce::Array<juce::File> files;
+    juce::WavAudioFormat wavFormat;
+    for (int i = 0; i < numFiles; ++i)
+    {
+        const auto file = folder.getChildFile("loop" + juce::String(i) + ".wav");
+        std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(
+            new juce::FileOutputStream(file), loop.sampleRate, 1, 16, {}, 0));
+        if (writer != nullptr)
+        {
+            writer->writeFromAudioSampleBuffer(mono, 0, numSamples);
+            files.add(file);
+        }
+    }
+
+    std::cout << std::endl << files.size() << " files" << std::endl;
+    std::cout << "threads     ms/file    speedup" << std::endl;
+
+    const int numCores = juce::SystemStats::getNumCpus();
+    double oneThreadMs = 0;
+    for (const int numThreads : { 1, numCores })
+    {
+        const double ms = timeFiles(files, numThreads) / juce::jmax(1, files.size());
+        if (numThreads == 1)
+        {
+            oneThreadMs = ms;
+        }
+
+        std::cout << juce::String(numThreads).paddedLeft(' ', 7)
+                  << juce::String(ms, 2).paddedLeft(' ', 12)
+                  << juce::String(oneThreadMs / ms, 2).paddedLeft(' ', 11) << std::endl;
+
+        if (numCores == 1)
+        {
+            break;
+        }
+    }
+
+    folder.deleteRecursively();
+}
+
+/**
+* Returns the average time, in milliseconds, one detector takes over the audio
+*/
+double TempoDetectionBenchmark::timeDetector(bool useSimd, const juce::AudioBuffer<float>& mono, double sampleRate, int numRuns, double& bpm)
+{
+    // the detector may overwrite what it is fed
+    std::vector<float> block((size_t) blockSize);
+    juce::int64 elapsed = 0;
+
+    for (int run = 0; run < numRuns; ++run)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        std::unique_ptr<soundtouch::BPMDetect> detector(useSimd
+            ? soundtouch::BPMDetect::newInstance(1, (int) sampleRate)
+            : new soundtouch::BPMDetect(1, (int) sampleRate));
+
+        for (int i = 0; i < mono.getNumSamples(); i += blockSize)
+        {
+            const int numToAnalyse = juce::jmin(blockSize, mono.getNumSamples() - i);
+            juce::FloatVectorOperations::copy(block.data(), mono.getReadPointer(0, i), numToAnalyse);
+            detector->inputSamples(block.data(), numToAnalyse);
+        }
+        bpm = detector->getBpm();
+
+        elapsed += juce::Time::getHighResolutionTicks() - start;
+    }
+    return juce::Time::highResolutionTicksToSeconds(elapsed) * 1000.0 / numRuns;
+}
+
+/**
+* Returns the time, in milliseconds, taken to find the tempo of every file
+*/
+double TempoDetectionBenchmark::timeFiles(const juce::Array<juce::File>& files, int numThreads)
+{
+    // a fresh detector each time, so nothing is remembered from the last run
+    TwoShotTempoDetector detector;
+
+    const auto start = juce::Time::getHighResolutionTicks();
+    detector.detectFiles(files, numThreads);
+    const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+    return juce::Time::highResolutionTicksToSeconds(elapsed) * 1000.0;
+}
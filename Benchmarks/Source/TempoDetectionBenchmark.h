@@ -0,0 +1,31 @@
+/*
+  ==============================================================================
+
+    TempoDetectionBenchmark.h
+    Created: 18 Oct 2026 1:36:22am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Measures what finding the tempo of a loop costs.
+ *
+ * The same audio is analysed by SoundTouch's plain BPMDetect and by the one
+ * BPMDetect::newInstance() picks for this CPU, which must find the same tempo. Then a
+ * folder of loops is analysed on one thread, and on every core.
+ */
+class TempoDetectionBenchmark
+{
+    public:
+        /** Runs the benchmark and prints a table of results */
+        static void run(int numFiles = 32, int numRuns = 5);
+
+    private:
+        static double timeDetector(bool useSimd, const juce::AudioBuffer<float>& mono, double sampleRate, int numRuns, double& bpm);
+        static double timeFiles(const juce::Array<juce::File>& files, int numThreads);
+};
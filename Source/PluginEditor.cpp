@@ -19,13 +19,16 @@ TwoShot_V2AudioProcessorEditor::TwoShot_V2AudioProcessorEditor (TwoShot_V2AudioP
     addAndMakeVisible(slider);
     addAndMakeVisible(m_reverseButton);
     addAndMakeVisible(m_modeButton);
+    addAndMakeVisible(m_slicingButton);
     slider.addListener(this);
     m_reverseButton.addListener(this);    
     m_modeButton.addListener(this);
+    m_slicingButton.addListener(this);
     slider.setRange(-1200.0, 1200);
     slider.setSliderStyle(juce::Slider::RotaryVerticalDrag);
     m_reverseButton.setButtonText("reverse");
     m_modeButton.setButtonText("mode");
+    m_slicingButton.setButtonText("slice at transients");
 }
 
 TwoShot_V2AudioProcessorEditor::~TwoShot_V2AudioProcessorEditor()
@@ -46,25 +49,25 @@ void TwoShot_V2AudioProcessorEditor::buttonClicked(Button* button)
 
     if (std::addressof(m_modeButton) == button)
     {
-        File* sample = new File(
-            File::getSpecialLocation(File::userDesktopDirectory)
+        File sample = File::getSpecialLocation(File::userDesktopDirectory)
             .getChildFile("Samples")
-            .getChildFile("112loop.wav")
-        );
-        std::unique_ptr<AudioFormatReader> fileReader(audioProcessor.m_formatManager.createReaderFor(*sample));
-        std::unique_ptr<AudioBuffer<float>> tempBuf (new AudioBuffer<float>());
-        tempBuf.get()->setSize(fileReader->numChannels, fileReader->lengthInSamples);
+            .getChildFile("112loop.wav");
         if (m_modeButton.getToggleState())
         {
-            audioProcessor.m_sampler.setAudio(std::move(*tempBuf.get()), fileReader->sampleRate, 112, 0);
-
+            audioProcessor.m_sampler.loadLoopFile(sample);
         }
         else
         {
-            audioProcessor.m_sampler.setAudio(std::move(*tempBuf.get()), fileReader->sampleRate, std::nullopt, 0);
-
+            audioProcessor.m_sampler.loadAudioFile(sample, std::nullopt);
         }
     }
+
+    if (std::addressof(m_slicingButton) == button)
+    {
+        audioProcessor.m_sampler.setSlicing(button->getToggleState()
+            ? TwoShotSlicer::Slicing::transients
+            : TwoShotSlicer::Slicing::bars);
+    }
 }
 
 void TwoShot_V2AudioProcessorEditor::buttonStateChanged(Button* button)
@@ -87,11 +90,13 @@ void TwoShot_V2AudioProcessorEditor::resized()
     Rectangle<int> bounds = getLocalBounds();
     Rectangle<int> modeBounds = bounds.removeFromBottom(100);
     Rectangle<int> reverseBounds = bounds.removeFromBottom(100);
+    Rectangle<int> slicingBounds = bounds.removeFromBottom(50);
 
     //label.setBounds(getLocalBounds());
     slider.setBounds(bounds);
     m_modeButton.setBounds(modeBounds);
     m_reverseButton.setBounds(reverseBounds);
+    m_slicingButton.setBounds(slicingBounds);
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
 }
@@ -37,6 +37,7 @@ private:
     juce::Slider slider;
     juce::ToggleButton m_reverseButton;
     juce::ToggleButton m_modeButton;
+    juce::ToggleButton m_slicingButton;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TwoShot_V2AudioProcessorEditor)
 };
@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "TwoShotRealtimeGuard.h"
 
 //==============================================================================
 TwoShot_V2AudioProcessor::TwoShot_V2AudioProcessor()
@@ -22,7 +23,6 @@ TwoShot_V2AudioProcessor::TwoShot_V2AudioProcessor()
                        )
 #endif
 {
-    m_formatManager.registerBasicFormats();
     // Use this method as the place to do any pre-playback
 // initialisation that you need..
 }
@@ -96,17 +96,12 @@ void TwoShot_V2AudioProcessor::changeProgramName (int index, const juce::String&
 //==============================================================================
 void TwoShot_V2AudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    File* sample = new File(
-        File::getSpecialLocation(File::userDesktopDirectory)
+    File sample = File::getSpecialLocation(File::userDesktopDirectory)
         .getChildFile("Samples")
-        .getChildFile("112loop.wav")
-    );
-    std::unique_ptr<AudioFormatReader> fileReader(m_formatManager.createReaderFor(*sample));
-    std::unique_ptr<AudioBuffer<float>> tempBuf(new AudioBuffer<float>());
-    tempBuf.get()->setSize(fileReader->numChannels, fileReader->lengthInSamples);
-    m_sampler.setAudio(std::move(*tempBuf.get()), fileReader->sampleRate, 112, 0);
+        .getChildFile("112loop.wav");
     m_sampler.setHostSampleRate(sampleRate);
-    m_sampler.setAudio(std::move(*tempBuf.get()), fileReader->sampleRate, std::nullopt, 0);
+    m_telemetry.prepare(sampleRate);
+    m_sampler.loadAudioFile(sample, std::nullopt);
     m_sampler.setAttack(0.01);
     m_sampler.setDecay(0.01);
     m_sampler.setDetune(0);
@@ -116,6 +111,12 @@ void TwoShot_V2AudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+   #if TWOSHOT_RT_GUARD
+    const auto report = juce::File::getSpecialLocation(juce::File::tempDirectory)
+        .getChildFile("TwoShotRealtimeReport.txt");
+    TwoShotRealtimeGuard::writeReport(report);
+    DBG("Real-time report written to " << report.getFullPathName());
+   #endif
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -146,6 +147,7 @@ bool TwoShot_V2AudioProcessor::isBusesLayoutSupported (const BusesLayout& layout
 
 void TwoShot_V2AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    TWOSHOT_REALTIME_CALLBACK
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -170,16 +172,24 @@ void TwoShot_V2AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, j
         auto* channelData = buffer.getWritePointer (channel);
 
     };
+    std::optional<const double> hostBpm;
     if (getPlayHead())
     {        
         getPlayHead()->getCurrentPosition(m_info);
-
-        m_sampler.processNextBlock(buffer, midiMessages, m_info.bpm);
-    }
-    else
-    {
-        m_sampler.processNextBlock(buffer, midiMessages, std::nullopt);
+        hostBpm.emplace(m_info.bpm);
     }
+
+    // only the synth is timed, not the host's play head
+    const auto renderStart = juce::Time::getHighResolutionTicks();
+    m_sampler.processNextBlock(buffer, midiMessages, hostBpm);
+    const auto renderEnd = juce::Time::getHighResolutionTicks();
+
+    m_telemetry.recordBlock(
+        renderEnd - renderStart,
+        m_sampler.getNumPlayingVoices(),
+        midiMessages.getNumEvents(),
+        buffer.getNumSamples()
+    );
 }
 
 //==============================================================================
@@ -10,6 +10,7 @@
 
 #include <JuceHeader.h>
 #include "TwoShotSynth.h"
+#include "TwoShotTelemetry.h"
 //==============================================================================
 /**
 */
@@ -54,8 +55,9 @@ public:
     void setStateInformation(const void* data, int sizeInBytes) override;
 
     TwoShotSynth m_sampler;
-    AudioFormatManager m_formatManager;
     juce::AudioPlayHead::CurrentPositionInfo m_info;
+    // how long each block takes to render, read by anything watching the plugin's load
+    TwoShotTelemetry m_telemetry;
 
 private:
     //==============================================================================
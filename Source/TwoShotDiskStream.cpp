@@ -0,0 +1,235 @@
+/*
+  ==============================================================================
+
+    TwoShotDiskStream.cpp
+    Created: 17 Oct 2026 1:48:22pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotDiskStream.h"
+#include "TwoShotSound.h"
+
+TwoShotDiskStream::TwoShotDiskStream(juce::TimeSliceThread& thread) : m_thread(thread)
+{
+    m_thread.addTimeSliceClient(this);
+}
+
+TwoShotDiskStream::~TwoShotDiskStream()
+{
+    m_thread.removeTimeSliceClient(this);
+
+    // drop the references of any requests the disk thread never got to
+    int start1, size1, start2, size2;
+    m_requestFifo.prepareToRead(m_requestFifo.getNumReady(), start1, size1, start2, size2);
+    for (int i = 0; i < size1 + size2; ++i)
+    {
+        auto& request = m_requests[(size_t) (i < size1 ? start1 + i : start2 + i - size1)];
+        if (request.source != nullptr)
+        {
+            request.source->decReferenceCount();
+        }
+    }
+}
+
+void TwoShotDiskStream::start(TwoShotAudioData* source, int regionStart, int regionLength, int firstFrame, bool isReversed) noexcept
+{
+    ++m_generation;
+    m_readBase = 0;
+    m_numFrames = jmax(0, regionLength - firstFrame);
+    m_isStreaming = true;
+
+    // the request covers the part of the file that isn't preloaded; a reversed
+    // region is preloaded from its end, so the streamed part starts at regionStart
+    const juce::int64 sourceStart = isReversed ? regionStart : regionStart + firstFrame;
+
+    // the reference travels with the request, and is released on the disk thread
+    source->incReferenceCount();
+    pushRequest({ source, sourceStart, m_numFrames, isReversed, m_generation });
+}
+
+void TwoShotDiskStream::stop() noexcept
+{
+    if (m_isStreaming)
+    {
+        ++m_generation;
+        m_isStreaming = false;
+        pushRequest({ nullptr, 0, 0, false, m_generation });
+    }
+}
+
+void TwoShotDiskStream::pushRequest(const Request& request) noexcept
+{
+    int start1, size1, start2, size2;
+    m_requestFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 + size2 == 0)
+    {
+        // the disk thread has stalled; the voice will play silence past its preloaded head.
+        // The sound being played still holds the source, so this can't free it.
+        jassertfalse;
+        if (request.source != nullptr)
+        {
+            request.source->decReferenceCount();
+        }
+        return;
+    }
+
+    m_requests[(size_t) (size1 > 0 ? start1 : start2)] = request;
+    m_requestFifo.finishedWrite(1);
+}
+
+void TwoShotDiskStream::read(juce::AudioBuffer<float>& dest, int destStart, int frame, int numFrames) noexcept
+{
+    int done = 0;
+
+    if (m_isStreaming && m_readyGeneration.load(std::memory_order_acquire) == m_generation)
+    {
+        const int numReady = m_ringFifo.getNumReady();
+        int start1, size1, start2, size2;
+        m_ringFifo.prepareToRead(numReady, start1, size1, start2, size2);
+
+        while (done < numFrames)
+        {
+            const int ringFrame = frame + done - m_readBase;
+
+            if (ringFrame < 0)
+            {
+                // already released, which only happens if the voice jumped backwards
+                const int numToClear = jmin(numFrames - done, -ringFrame);
+                dest.clear(destStart + done, numToClear);
+                done += numToClear;
+                continue;
+            }
+            if (ringFrame >= numReady)
+            {
+                break;
+            }
+
+            const int ringIndex = ringFrame < size1 ? start1 + ringFrame : start2 + ringFrame - size1;
+            const int runLength = jmin(numFrames - done, ringFrame < size1 ? size1 - ringFrame : size2 - (ringFrame - size1));
+
+            for (int channel = 0; channel < dest.getNumChannels(); ++channel)
+            {
+                dest.copyFrom(channel, destStart + done, m_ring, jmin(channel, 1), ringIndex, runLength);
+            }
+            done += runLength;
+        }
+    }
+
+    if (done < numFrames)
+    {
+        dest.clear(destStart + done, numFrames - done);
+
+        const int numMissing = jmin(numFrames, m_numFrames - frame) - done;
+        if (numMissing > 0)
+        {
+            m_numUnderruns += numMissing;
+        }
+    }
+}
+
+void TwoShotDiskStream::release(int frame) noexcept
+{
+    if (m_isStreaming && m_readyGeneration.load(std::memory_order_acquire) == m_generation)
+    {
+        const int numToRelease = jlimit(0, m_ringFifo.getNumReady(), frame - m_readBase);
+        m_ringFifo.finishedRead(numToRelease);
+        m_readBase += numToRelease;
+    }
+}
+
+int TwoShotDiskStream::useTimeSlice()
+{
+    takeRequests();
+
+    if (m_source == nullptr)
+    {
+        return 10;
+    }
+
+    fillRing();
+
+    const bool hasMoreToRead = m_writeFrame < m_sourceFrames;
+    return hasMoreToRead && m_ringFifo.getFreeSpace() >= chunkSize ? 0 : 5;
+}
+
+void TwoShotDiskStream::takeRequests()
+{
+    const int numRequests = m_requestFifo.getNumReady();
+
+    if (numRequests == 0)
+    {
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    m_requestFifo.prepareToRead(numRequests, start1, size1, start2, size2);
+
+    // only the latest request matters, the voice has already moved on from the others
+    for (int i = 0; i < numRequests - 1; ++i)
+    {
+        auto& skipped = m_requests[(size_t) (i < size1 ? start1 + i : start2 + i - size1)];
+        if (skipped.source != nullptr)
+        {
+            skipped.source->decReferenceCount();
+        }
+    }
+
+    const int last = numRequests - 1;
+    const Request request = m_requests[(size_t) (last < size1 ? start1 + last : start2 + last - size1)];
+    m_requestFifo.finishedRead(numRequests);
+
+    m_source = request.source;
+    if (request.source != nullptr)
+    {
+        request.source->decReferenceCount();
+    }
+
+    m_sourceStart = request.sourceStart;
+    m_sourceFrames = request.numFrames;
+    m_sourceIsReversed = request.isReversed;
+    m_writeFrame = 0;
+    m_ringFifo.reset();
+
+    if (m_source != nullptr)
+    {
+        fillRing();
+    }
+    m_readyGeneration.store(request.generation, std::memory_order_release);
+}
+
+void TwoShotDiskStream::fillRing()
+{
+    const int numToRead = jmin(m_ringFifo.getFreeSpace(), (int) chunkSize, m_sourceFrames - m_writeFrame);
+
+    if (numToRead <= 0)
+    {
+        return;
+    }
+
+    // a reversed region is read from its end backwards, one chunk at a time
+    const juce::int64 readStart = m_sourceIsReversed
+        ? m_sourceStart + m_sourceFrames - m_writeFrame - numToRead
+        : m_sourceStart + m_writeFrame;
+
+    m_source->readFromFile(m_chunk, 0, readStart, numToRead);
+    if (m_sourceIsReversed)
+    {
+        m_chunk.reverse(0, numToRead);
+    }
+
+    int start1, size1, start2, size2;
+    m_ringFifo.prepareToWrite(numToRead, start1, size1, start2, size2);
+    for (int channel = 0; channel < m_ring.getNumChannels(); ++channel)
+    {
+        m_ring.copyFrom(channel, start1, m_chunk, channel, 0, size1);
+        if (size2 > 0)
+        {
+            m_ring.copyFrom(channel, start2, m_chunk, channel, size1, size2);
+        }
+    }
+    m_ringFifo.finishedWrite(size1 + size2);
+    m_writeFrame += size1 + size2;
+}
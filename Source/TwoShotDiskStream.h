@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    TwoShotDiskStream.h
+    Created: 17 Oct 2026 1:48:22pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class TwoShotAudioData;
+
+/**
+ * Streams one region of a file from disk for a single voice.
+ *
+ * A shared TimeSliceThread reads ahead into a ring buffer, in playback order, so a
+ * reversed region arrives already reversed. The voice reads from the ring on the
+ * audio thread without locking or allocating; frames that haven't arrived in time
+ * are rendered as silence and counted as underruns.
+ *
+ * Frames are numbered from 0 at the first streamed frame of the region.
+ */
+class TwoShotDiskStream : private juce::TimeSliceClient
+{
+    public:
+        explicit TwoShotDiskStream(juce::TimeSliceThread& thread);
+        ~TwoShotDiskStream() override;
+
+        /**
+         * Starts streaming a region of the source file. Called from the audio thread.
+         * @param firstFrame    the offset into the region, in playback order, of stream frame 0
+         */
+        void start(TwoShotAudioData* source, int regionStart, int regionLength, int firstFrame, bool isReversed) noexcept;
+
+        /** Stops streaming and lets go of the source. Called from the audio thread. */
+        void stop() noexcept;
+
+        /**
+         * Copies frames [frame, frame + numFrames) into dest, zeroing any that aren't available.
+         * Called from the audio thread.
+         */
+        void read(juce::AudioBuffer<float>& dest, int destStart, int frame, int numFrames) noexcept;
+
+        /** Tells the stream that frames before this one won't be read again. Called from the audio thread. */
+        void release(int frame) noexcept;
+
+        /** The number of frames so far that were needed but hadn't been read from disk yet */
+        int getNumUnderruns() const noexcept { return m_numUnderruns.load(); }
+
+        /** The number of frames read ahead of the voice */
+        static constexpr int ringSize = 32768;
+
+        /** The most frames read from disk in one go */
+        static constexpr int chunkSize = 4096;
+
+    private:
+        struct Request
+        {
+            TwoShotAudioData* source;
+            juce::int64 sourceStart;
+            int numFrames;
+            bool isReversed;
+            juce::uint32 generation;
+        };
+
+        int useTimeSlice() override;
+        void takeRequests();
+        void fillRing();
+        void pushRequest(const Request& request) noexcept;
+
+        juce::TimeSliceThread& m_thread;
+
+        // audio thread -> disk thread
+        static constexpr int maxRequests = 16;
+        juce::AbstractFifo m_requestFifo { maxRequests };
+        std::array<Request, maxRequests> m_requests {};
+
+        // the ring, written by the disk thread and read by the audio thread
+        juce::AbstractFifo m_ringFifo { ringSize };
+        juce::AudioBuffer<float> m_ring { 2, ringSize };
+        std::atomic<juce::uint32> m_readyGeneration { 0 };
+        std::atomic<int> m_numUnderruns { 0 };
+
+        // audio thread state
+        juce::uint32 m_generation = 0;
+        int m_readBase = 0;
+        int m_numFrames = 0;
+        bool m_isStreaming = false;
+
+        // disk thread state
+        juce::ReferenceCountedObjectPtr<TwoShotAudioData> m_source;
+        juce::AudioBuffer<float> m_chunk { 2, chunkSize };
+        juce::int64 m_sourceStart = 0;
+        int m_sourceFrames = 0;
+        int m_writeFrame = 0;
+        bool m_sourceIsReversed = false;
+};
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    TwoShotEnvelope.cpp
+    Created: 18 Oct 2026 4:06:22am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotEnvelope.h"
+
+void TwoShotEnvelope::setSampleRate(double newSampleRate) noexcept
+{
+    jassert(newSampleRate > 0);
+    m_sampleRate = newSampleRate;
+}
+
+void TwoShotEnvelope::setParameters(const juce::ADSR::Parameters& newParameters) noexcept
+{
+    m_parameters = newParameters;
+}
+
+void TwoShotEnvelope::noteOn() noexcept
+{
+    m_attackRate = m_parameters.attack > 0 ? (float) (1.0 / (m_parameters.attack * m_sampleRate)) : 0.0f;
+    m_decayRate = m_parameters.decay > 0 ? (float) ((1.0 - m_parameters.sustain) / (m_parameters.decay * m_sampleRate)) : 0.0f;
+
+    // a retriggered note rises from where it was, as juce::ADSR does
+    if (m_attackRate > 0)
+    {
+        m_stage = Stage::attack;
+    }
+    else
+    {
+        m_level = 1.0f;
+        startAfterAttack();
+    }
+}
+
+void TwoShotEnvelope::noteOff() noexcept
+{
+    if (m_stage == Stage::idle)
+    {
+        return;
+    }
+
+    if (m_parameters.release > 0 && m_level > 0)
+    {
+        m_releaseRate = (float) (m_level / (m_parameters.release * m_sampleRate));
+        m_stage = Stage::release;
+    }
+    else
+    {
+        reset();
+    }
+}
+
+void TwoShotEnvelope::reset() noexcept
+{
+    m_level = 0;
+    m_stage = Stage::idle;
+}
+
+void TwoShotEnvelope::startAfterAttack() noexcept
+{
+    if (m_decayRate > 0 && m_level > m_parameters.sustain)
+    {
+        m_stage = Stage::decay;
+    }
+    else
+    {
+        m_level = m_parameters.sustain;
+        m_stage = Stage::sustain;
+    }
+}
+
+/**
+* Fills dest a stage at a time: a ramp for each moving stage, then one value for the rest
+* of the block once the level holds
+*/
+void TwoShotEnvelope::render(float* dest, int numSamples, float gain) noexcept
+{
+    int done = 0;
+    while (done < numSamples)
+    {
+        switch (m_stage)
+        {
+            case Stage::attack:
+                done += ramp(dest + done, numSamples - done, m_attackRate, 1.0f, gain);
+                break;
+
+            case Stage::decay:
+                done += ramp(dest + done, numSamples - done, -m_decayRate, m_parameters.sustain, gain);
+                break;
+
+            case Stage::release:
+                done += ramp(dest + done, numSamples - done, -m_releaseRate, 0.0f, gain);
+                break;
+
+            case Stage::sustain:
+            case Stage::idle:
+            default:
+                juce::FloatVectorOperations::fill(dest + done, m_level * gain, numSamples - done);
+                return;
+        }
+    }
+}
+
+/**
+* Moves the level by rate each sample until it reaches target, or the block runs out.
+* The sample that reaches the target lands exactly on it, and the next stage starts after it
+* @return how many samples were written
+*/
+int TwoShotEnvelope::ramp(float* dest, int numSamples, float rate, float target, float gain) noexcept
+{
+    const int numToTarget = juce::jmax(1, (int) std::ceil((target - m_level) / rate));
+    const int numToWrite = juce::jmin(numSamples, numToTarget);
+
+    // worked out from the start of the ramp rather than accumulated, so it vectorises
+    const float start = m_level * gain;
+    const float step = rate * gain;
+    for (int i = 0; i < numToWrite; ++i)
+    {
+        dest[i] = start + step * (float) (i + 1);
+    }
+
+    if (numToWrite < numToTarget)
+    {
+        m_level += rate * (float) numToWrite;
+        return numToWrite;
+    }
+
+    dest[numToWrite - 1] = target * gain;
+    m_level = target;
+
+    switch (m_stage)
+    {
+        case Stage::attack:
+            startAfterAttack();
+            break;
+        case Stage::decay:
+            m_stage = Stage::sustain;
+            break;
+        case Stage::release:
+        default:
+            reset();
+            break;
+    }
+    return numToWrite;
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    TwoShotEnvelope.h
+    Created: 18 Oct 2026 4:06:22am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * A voice's attack, decay, sustain and release, rendered a block at a time.
+ *
+ * It follows the same straight-line stages as juce::ADSR, but rather than being asked for
+ * every sample, it writes each stage that falls in a block as one ramp, and a block spent
+ * at the sustain level as a single value. isFlat() tells the voice when that is, so it can
+ * skip working out per-sample gains altogether.
+ *
+ * It runs at the rate the voice renders at, not the sound's, so the times set are the
+ * times heard whatever rate the audio was recorded at.
+ */
+class TwoShotEnvelope
+{
+    public:
+        /** Sets the rate the envelope is rendered at. Stages already under way keep their old speed */
+        void setSampleRate(double newSampleRate) noexcept;
+
+        /** Sets the stage times and the sustain level, taking effect at the next noteOn() */
+        void setParameters(const juce::ADSR::Parameters& newParameters) noexcept;
+
+        void noteOn() noexcept;
+
+        /** Starts the release from wherever the envelope has got to */
+        void noteOff() noexcept;
+
+        /** Drops straight to silence */
+        void reset() noexcept;
+
+        /** Returns false once the release has finished, or before the first note */
+        bool isActive() const noexcept { return m_stage != Stage::idle; }
+
+        /** Returns true while the envelope holds the same level, so a block gets the same gain throughout */
+        bool isFlat() const noexcept { return m_stage == Stage::sustain || m_stage == Stage::idle; }
+
+        /** Returns the level the envelope has reached */
+        float getLevel() const noexcept { return m_level; }
+
+        /** Writes the next numSamples levels of the envelope into dest, each times gain */
+        void render(float* dest, int numSamples, float gain) noexcept;
+
+    private:
+        enum class Stage
+        {
+            idle,
+            attack,
+            decay,
+            sustain,
+            release
+        };
+
+        int ramp(float* dest, int numSamples, float rate, float target, float gain) noexcept;
+        void startAfterAttack() noexcept;
+
+        juce::ADSR::Parameters m_parameters;
+        double m_sampleRate = 44100;
+        Stage m_stage = Stage::idle;
+        float m_level = 0;
+
+        // how far the level moves per sample in each stage, worked out when it starts
+        float m_attackRate = 0;
+        float m_decayRate = 0;
+        float m_releaseRate = 0;
+};
@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    TwoShotLoader.cpp
+    Created: 17 Oct 2026 10:21:37am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotLoader.h"
+#include "TwoShotSynth.h"
+
+TwoShotLoader::TwoShotLoader(TwoShotSynth& synth) :
+    juce::Thread("TwoShot loader"),
+    m_synth(synth)
+{
+    m_formatManager.registerBasicFormats();
+    startThread(4);
+}
+
+TwoShotLoader::~TwoShotLoader()
+{
+    stop();
+}
+
+void TwoShotLoader::stop()
+{
+    stopThread(4000);
+}
+
+void TwoShotLoader::loadAudioFile(const juce::File& file, std::optional<const double> audioBpm)
+{
+    {
+        const juce::ScopedLock sl(m_requestLock);
+        m_request = Request { file, audioBpm };
+    }
+    notify();
+}
+
+void TwoShotLoader::loadLoopFile(const juce::File& file)
+{
+    {
+        const juce::ScopedLock sl(m_requestLock);
+        m_request = Request { file, std::nullopt, true };
+    }
+    notify();
+}
+
+void TwoShotLoader::run()
+{
+    while (! threadShouldExit())
+    {
+        if (auto request = takeRequest())
+        {
+            load(*request);
+        }
+        else
+        {
+            wait(-1);
+        }
+    }
+}
+
+std::optional<TwoShotLoader::Request> TwoShotLoader::takeRequest()
+{
+    const juce::ScopedLock sl(m_requestLock);
+    std::optional<Request> request;
+    std::swap(request, m_request);
+    return request;
+}
+
+void TwoShotLoader::load(const Request& request)
+{
+    std::unique_ptr<juce::AudioFormatReader> fileReader(m_formatManager.createReaderFor(request.file));
+
+    if (fileReader == nullptr)
+    {
+        DBG("TwoShotLoader: couldn't open " + request.file.getFullPathName());
+        return;
+    }
+
+    const double lengthSeconds = (double) fileReader->lengthInSamples / fileReader->sampleRate;
+
+    if (m_synth.shouldStreamFromDisk(lengthSeconds))
+    {
+        // memory-map the file where the format allows it, so the disk thread's reads are plain copies
+        if (auto* format = m_formatManager.findFormatForFileExtension(request.file.getFileExtension()))
+        {
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader(format->createMemoryMappedReader(request.file));
+
+            if (mappedReader != nullptr && mappedReader->mapEntireFile())
+            {
+                fileReader = std::move(mappedReader);
+            }
+        }
+
+        const auto tempo = getTempo(request, *fileReader, nullptr);
+        m_synth.setAudio(
+            new TwoShotAudioData(std::move(fileReader)),
+            tempo.has_value() ? tempo->bpm : request.audioBpm,
+            tempo.has_value() ? tempo->beatOffset : 0
+        );
+        return;
+    }
+
+    // audio past the longest a sample may be would only be decoded to be thrown away
+    const double sampleRate = fileReader->sampleRate;
+    const auto maxNumSamples = (juce::int64) (TwoShotSynth::maxSampleLengthSeconds * sampleRate);
+    const int numSamples = (int) juce::jmin(fileReader->lengthInSamples, maxNumSamples);
+    juce::AudioBuffer<float> buffer((int) fileReader->numChannels, numSamples);
+    fileReader->read(&buffer, 0, numSamples, 0, true, true);
+
+    if (threadShouldExit())
+    {
+        return;
+    }
+
+    const auto tempo = getTempo(request, *fileReader, &buffer);
+    m_synth.setAudio(
+        new TwoShotAudioData(std::move(buffer), sampleRate, numSamples),
+        tempo.has_value() ? tempo->bpm : request.audioBpm,
+        tempo.has_value() ? tempo->beatOffset : 0
+    );
+}
+
+/**
+* Returns the tempo of a loop loaded without one: remembered from an earlier load of the file,
+* or detected from the decoded buffer if there is one, or else from the reader
+*/
+std::optional<TwoShotTempoDetector::Tempo> TwoShotLoader::getTempo(
+    const Request& request,
+    juce::AudioFormatReader& reader,
+    const juce::AudioBuffer<float>* buffer
+)
+{
+    if (! request.shouldDetectTempo)
+    {
+        return std::nullopt;
+    }
+
+    auto tempo = m_tempoDetector.findTempo(request.file);
+    if (! tempo.has_value())
+    {
+        tempo = buffer != nullptr
+            ? m_tempoDetector.detect(request.file, *buffer, reader.sampleRate)
+            : m_tempoDetector.detect(request.file, reader);
+    }
+
+    if (! tempo.has_value())
+    {
+        DBG("TwoShotLoader: couldn't find the tempo of " + request.file.getFullPathName() + ", loading it as a sample");
+    }
+    return tempo;
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    TwoShotLoader.h
+    Created: 17 Oct 2026 10:21:37am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TwoShotTempoDetector.h"
+
+class TwoShotSynth;
+
+/**
+ * Decodes audio files on a dedicated thread and hands the result to the synth,
+ * so that neither the UI nor the audio thread ever waits for disk or decoding.
+ *
+ * Only the most recent request is kept: if the user picks several files in quick
+ * succession, the ones that haven't started loading yet are skipped.
+ */
+class TwoShotLoader : private juce::Thread
+{
+    public:
+        explicit TwoShotLoader(TwoShotSynth& synth);
+        ~TwoShotLoader() override;
+
+        /**
+         * Queues a file to be loaded into the synth
+         * @param audioBpm if this value is present, the synth goes into LOOP MODE
+         */
+        void loadAudioFile(const juce::File& file, std::optional<const double> audioBpm);
+
+        /** Queues a loop to be loaded into the synth in LOOP MODE, at the tempo detected from it */
+        void loadLoopFile(const juce::File& file);
+
+        /** Stops the loader thread, abandoning any request that hasn't been loaded yet */
+        void stop();
+
+    private:
+        struct Request
+        {
+            juce::File file;
+            std::optional<double> audioBpm;
+            bool shouldDetectTempo = false;
+        };
+
+        void run() override;
+        std::optional<Request> takeRequest();
+        void load(const Request& request);
+        std::optional<TwoShotTempoDetector::Tempo> getTempo(
+            const Request& request,
+            juce::AudioFormatReader& reader,
+            const juce::AudioBuffer<float>* buffer
+        );
+
+        TwoShotSynth& m_synth;
+        juce::AudioFormatManager m_formatManager;
+        juce::CriticalSection m_requestLock;
+        std::optional<Request> m_request;
+        // only used on the loader thread
+        TwoShotTempoDetector m_tempoDetector;
+};
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    TwoShotLruCache.h
+    Created: 17 Oct 2026 11:02:36pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <list>
+
+/**
+ * Keeps the values for the keys used most recently, forgetting the least recently used
+ * once it holds maxNumEntries. Not thread safe, the owner locks around it if it is shared.
+ */
+template <typename Key, typename Value>
+class TwoShotLruCache
+{
+    public:
+        explicit TwoShotLruCache(int maxNumEntries) : m_maxNumEntries(maxNumEntries)
+        {
+            jassert(maxNumEntries > 0);
+        }
+
+        /**
+         * Returns the value kept for the key, now the most recently used, or nullptr if there
+         * is none. It stays where it is until it is replaced or forgotten
+         */
+        Value* find(const Key& key)
+        {
+            for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+            {
+                if (it->key == key)
+                {
+                    m_entries.splice(m_entries.begin(), m_entries, it);
+                    return &it->value;
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * Keeps the value for the key as the most recently used, replacing whatever was
+         * kept for it rather than pushing out another entry
+         * @return the value as it is kept
+         */
+        Value& insert(const Key& key, Value value)
+        {
+            m_entries.remove_if([&key] (const Entry& entry) { return entry.key == key; });
+
+            m_entries.push_front({ key, std::move(value) });
+            if ((int) m_entries.size() > m_maxNumEntries)
+            {
+                m_entries.pop_back();
+            }
+            return m_entries.front().value;
+        }
+
+        int size() const noexcept { return (int) m_entries.size(); }
+
+    private:
+        struct Entry
+        {
+            Key key;
+            Value value;
+        };
+
+        const int m_maxNumEntries;
+
+        // most recently used first
+        std::list<Entry> m_entries;
+
+        JUCE_DECLARE_NON_COPYABLE(TwoShotLruCache)
+};
@@ -0,0 +1,467 @@
+/*
+  ==============================================================================
+
+    TwoShotRealtimeGuard.cpp
+    Created: 17 Oct 2026 10:48:26pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotRealtimeGuard.h"
+#include <cstdlib>
+#include <new>
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+ #include <dbghelp.h>
+ #pragma comment(lib, "DbgHelp.lib")
+#elif JUCE_LINUX || JUCE_MAC
+ #include <execinfo.h>
+#endif
+
+#if TWOSHOT_RT_GUARD && JUCE_LINUX
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <unistd.h>
+ #include <sys/mman.h>
+#endif
+
+namespace
+{
+    using Event = TwoShotRealtimeGuard::Event;
+    constexpr int numEvents = 4;
+
+    /** One stack that caught something, and how often it has */
+    struct Site
+    {
+        std::atomic<juce::uint64> key;
+        Event event;
+        const char* function;
+        int numFrames;
+        void* frames[TwoShotRealtimeGuard::maxNumFrames];
+        std::atomic<juce::int64> count;
+    };
+
+    // written from whichever threads run callbacks, so nothing here is ever allocated
+    Site sites[TwoShotRealtimeGuard::maxNumSites];
+    std::atomic<juce::int64> totals[numEvents];
+    std::atomic<juce::int64> numCallbacks { 0 };
+    std::atomic<juce::int64> numUnrecordedSites { 0 };
+    std::atomic<bool> isTrapping { false };
+
+    thread_local bool isInCallback = false;
+    // stops the hooks catching what recording itself does
+    thread_local bool isRecording = false;
+
+    int captureStack(void** frames, int maxNumFrames) noexcept
+    {
+       #if JUCE_WINDOWS
+        return (int) CaptureStackBackTrace(2, (DWORD) maxNumFrames, frames, nullptr);
+       #elif JUCE_LINUX || JUCE_MAC
+        return backtrace(frames, maxNumFrames);
+       #else
+        juce::ignoreUnused(frames, maxNumFrames);
+        return 0;
+       #endif
+    }
+
+    juce::uint64 hashSite(Event event, const char* function, void* const* frames, int numFrames) noexcept
+    {
+        juce::uint64 hash = 14695981039346656037ull;
+        auto add = [&hash](juce::uint64 value)
+        {
+            hash = (hash ^ value) * 1099511628211ull;
+        };
+
+        add((juce::uint64) event);
+        add((juce::uint64) (juce::pointer_sized_uint) function);
+        for (int i = 0; i < numFrames; ++i)
+        {
+            add((juce::uint64) (juce::pointer_sized_uint) frames[i]);
+        }
+        // 0 marks an empty site
+        return hash != 0 ? hash : 1;
+    }
+
+    const char* getEventName(Event event) noexcept
+    {
+        switch (event)
+        {
+            case Event::allocation:   return "allocation";
+            case Event::deallocation: return "deallocation";
+            case Event::lock:         return "lock";
+            case Event::systemCall:   return "system call";
+        }
+        return "";
+    }
+
+    juce::StringArray symbolise(void* const* frames, int numFrames)
+    {
+        juce::StringArray lines;
+
+       #if JUCE_WINDOWS
+        auto process = GetCurrentProcess();
+        static const bool symbolsLoaded = SymInitialize(process, nullptr, TRUE) != FALSE;
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            char symbolBuffer[sizeof(SYMBOL_INFO) + 256] = {};
+            auto* symbol = reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
+            symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+            symbol->MaxNameLen = 255;
+
+            const auto address = (DWORD64) (juce::pointer_sized_uint) frames[i];
+            if (symbolsLoaded && SymFromAddr(process, address, nullptr, symbol))
+            {
+                lines.add(juce::String(symbol->Name) + " + 0x" + juce::String::toHexString((juce::int64) (address - symbol->Address)));
+            }
+            else
+            {
+                lines.add("0x" + juce::String::toHexString((juce::int64) address));
+            }
+        }
+       #elif JUCE_LINUX || JUCE_MAC
+        if (char** symbols = backtrace_symbols(frames, numFrames))
+        {
+            for (int i = 0; i < numFrames; ++i)
+            {
+                lines.add(symbols[i]);
+            }
+            std::free(symbols);
+        }
+       #else
+        juce::ignoreUnused(frames, numFrames);
+       #endif
+
+        return lines;
+    }
+}
+
+//==============================================================================
+TwoShotRealtimeGuard::ScopedCallback::ScopedCallback() noexcept :
+    m_wasInCallback(isInCallback)
+{
+    numCallbacks.fetch_add(1, std::memory_order_relaxed);
+    isInCallback = true;
+}
+
+TwoShotRealtimeGuard::ScopedCallback::~ScopedCallback() noexcept
+{
+    isInCallback = m_wasInCallback;
+}
+
+void TwoShotRealtimeGuard::setTrapping(bool shouldTrap) noexcept
+{
+    isTrapping = shouldTrap;
+}
+
+void TwoShotRealtimeGuard::record(Event event, const char* function) noexcept
+{
+    if (! isInCallback || isRecording)
+    {
+        return;
+    }
+    isRecording = true;
+
+    totals[(int) event].fetch_add(1, std::memory_order_relaxed);
+
+    void* frames[maxNumFrames];
+    const int numFrames = captureStack(frames, maxNumFrames);
+    const auto key = hashSite(event, function, frames, numFrames);
+
+    // an open-addressed table, claimed one site at a time with a compare-and-swap
+    bool isRecorded = false;
+    for (int probe = 0; probe < maxNumSites && ! isRecorded; ++probe)
+    {
+        auto& site = sites[(key + (juce::uint64) probe) % maxNumSites];
+        auto siteKey = site.key.load(std::memory_order_acquire);
+
+        if (siteKey == 0)
+        {
+            juce::uint64 empty = 0;
+            if (site.key.compare_exchange_strong(empty, key))
+            {
+                site.event = event;
+                site.function = function;
+                site.numFrames = numFrames;
+                std::copy(frames, frames + numFrames, site.frames);
+                siteKey = key;
+            }
+            else
+            {
+                siteKey = empty;
+            }
+        }
+
+        if (siteKey == key)
+        {
+            site.count.fetch_add(1, std::memory_order_relaxed);
+            isRecorded = true;
+        }
+    }
+
+    if (! isRecorded)
+    {
+        numUnrecordedSites.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (isTrapping)
+    {
+        std::abort();
+    }
+    isRecording = false;
+}
+
+juce::String TwoShotRealtimeGuard::createReport()
+{
+    const bool wasRecording = isRecording;
+    isRecording = true;
+
+    juce::String report;
+    report << "TwoShot real-time report: " << numCallbacks.load() << " callbacks" << juce::newLine;
+
+    for (int event = 0; event < numEvents; ++event)
+    {
+        report << "  " << getEventName((Event) event) << "s: " << totals[event].load() << juce::newLine;
+    }
+    if (numUnrecordedSites > 0)
+    {
+        report << "  (" << numUnrecordedSites.load() << " events from call sites that didn't fit in the table)" << juce::newLine;
+    }
+
+    juce::Array<const Site*> usedSites;
+    for (const auto& site : sites)
+    {
+        if (site.key.load() != 0)
+        {
+            usedSites.add(&site);
+        }
+    }
+    std::sort(usedSites.begin(), usedSites.end(), [](const Site* a, const Site* b)
+    {
+        return a->count.load() > b->count.load();
+    });
+
+    for (const auto* site : usedSites)
+    {
+        report << juce::newLine << site->count.load() << " x " << getEventName(site->event);
+        if (site->function != nullptr)
+        {
+            report << " in " << site->function;
+        }
+        report << juce::newLine;
+
+        for (const auto& line : symbolise(site->frames, site->numFrames))
+        {
+            report << "    " << line << juce::newLine;
+        }
+    }
+
+    isRecording = wasRecording;
+    return report;
+}
+
+bool TwoShotRealtimeGuard::writeReport(const juce::File& file)
+{
+    return file.replaceWithText(createReport());
+}
+
+void TwoShotRealtimeGuard::reset() noexcept
+{
+    for (auto& site : sites)
+    {
+        site.count = 0;
+        site.key = 0;
+    }
+    for (auto& total : totals)
+    {
+        total = 0;
+    }
+    numCallbacks = 0;
+    numUnrecordedSites = 0;
+}
+
+#if TWOSHOT_RT_GUARD
+//==============================================================================
+// the global allocation functions, replaced for this module
+namespace
+{
+    void* allocate(std::size_t size)
+    {
+        TwoShotRealtimeGuard::record(Event::allocation, "operator new");
+        if (void* memory = std::malloc(size > 0 ? size : 1))
+        {
+            return memory;
+        }
+        throw std::bad_alloc();
+    }
+
+    void deallocate(void* memory) noexcept
+    {
+        if (memory != nullptr)
+        {
+            TwoShotRealtimeGuard::record(Event::deallocation, "operator delete");
+            std::free(memory);
+        }
+    }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void* memory) noexcept { deallocate(memory); }
+void operator delete[](void* memory) noexcept { deallocate(memory); }
+void operator delete(void* memory, std::size_t) noexcept { deallocate(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { deallocate(memory); }
+
+#if JUCE_WINDOWS
+//==============================================================================
+// Windows: this module's imports of the locking and file functions are pointed at these
+namespace
+{
+    #define TWOSHOT_WINDOWS_HOOK(event, returnType, name, params, args) \
+        returnType (WINAPI* original##name) params = nullptr; \
+        returnType WINAPI hooked##name params \
+        { \
+            TwoShotRealtimeGuard::record(Event::event, #name); \
+            return original##name args; \
+        }
+
+    TWOSHOT_WINDOWS_HOOK(lock, void, EnterCriticalSection, (LPCRITICAL_SECTION section), (section))
+    TWOSHOT_WINDOWS_HOOK(lock, void, AcquireSRWLockExclusive, (PSRWLOCK srwLock), (srwLock))
+    TWOSHOT_WINDOWS_HOOK(lock, void, AcquireSRWLockShared, (PSRWLOCK srwLock), (srwLock))
+    TWOSHOT_WINDOWS_HOOK(lock, DWORD, WaitForSingleObject, (HANDLE handle, DWORD milliseconds), (handle, milliseconds))
+    TWOSHOT_WINDOWS_HOOK(systemCall, void, Sleep, (DWORD milliseconds), (milliseconds))
+    TWOSHOT_WINDOWS_HOOK(systemCall, HANDLE, CreateFileW,
+        (LPCWSTR name, DWORD access, DWORD share, LPSECURITY_ATTRIBUTES security, DWORD disposition, DWORD flags, HANDLE tmpl),
+        (name, access, share, security, disposition, flags, tmpl))
+    TWOSHOT_WINDOWS_HOOK(systemCall, BOOL, ReadFile,
+        (HANDLE file, LPVOID buffer, DWORD numBytes, LPDWORD numRead, LPOVERLAPPED overlapped),
+        (file, buffer, numBytes, numRead, overlapped))
+    TWOSHOT_WINDOWS_HOOK(systemCall, BOOL, WriteFile,
+        (HANDLE file, LPCVOID buffer, DWORD numBytes, LPDWORD numWritten, LPOVERLAPPED overlapped),
+        (file, buffer, numBytes, numWritten, overlapped))
+
+    #undef TWOSHOT_WINDOWS_HOOK
+
+    struct ImportHook
+    {
+        const char* name;
+        void* replacement;
+        void** original;
+    };
+
+    #define TWOSHOT_IMPORT_HOOK(name) { #name, (void*) &hooked##name, (void**) &original##name }
+
+    const ImportHook importHooks[] =
+    {
+        TWOSHOT_IMPORT_HOOK(EnterCriticalSection),
+        TWOSHOT_IMPORT_HOOK(AcquireSRWLockExclusive),
+        TWOSHOT_IMPORT_HOOK(AcquireSRWLockShared),
+        TWOSHOT_IMPORT_HOOK(WaitForSingleObject),
+        TWOSHOT_IMPORT_HOOK(Sleep),
+        TWOSHOT_IMPORT_HOOK(CreateFileW),
+        TWOSHOT_IMPORT_HOOK(ReadFile),
+        TWOSHOT_IMPORT_HOOK(WriteFile)
+    };
+
+    #undef TWOSHOT_IMPORT_HOOK
+
+    /** Points this module's import table entries for the hooked functions at the hooks */
+    void patchImports()
+    {
+        HMODULE module = nullptr;
+        if (! GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                                 reinterpret_cast<LPCWSTR>(&patchImports), &module))
+        {
+            return;
+        }
+
+        auto* base = reinterpret_cast<BYTE*>(module);
+        ULONG size = 0;
+        auto* descriptor = static_cast<PIMAGE_IMPORT_DESCRIPTOR>(
+            ImageDirectoryEntryToData(module, TRUE, IMAGE_DIRECTORY_ENTRY_IMPORT, &size));
+
+        for (; descriptor != nullptr && descriptor->Name != 0; ++descriptor)
+        {
+            if (descriptor->OriginalFirstThunk == 0)
+            {
+                continue;
+            }
+
+            auto* nameThunk = reinterpret_cast<PIMAGE_THUNK_DATA>(base + descriptor->OriginalFirstThunk);
+            auto* addressThunk = reinterpret_cast<PIMAGE_THUNK_DATA>(base + descriptor->FirstThunk);
+
+            for (; nameThunk->u1.AddressOfData != 0; ++nameThunk, ++addressThunk)
+            {
+                if (IMAGE_SNAP_BY_ORDINAL(nameThunk->u1.Ordinal))
+                {
+                    continue;
+                }
+
+                const auto* import = reinterpret_cast<PIMAGE_IMPORT_BY_NAME>(base + nameThunk->u1.AddressOfData);
+                for (const auto& hook : importHooks)
+                {
+                    if (std::strcmp(reinterpret_cast<const char*>(import->Name), hook.name) == 0)
+                    {
+                        DWORD protection = 0;
+                        VirtualProtect(&addressThunk->u1.Function, sizeof(void*), PAGE_READWRITE, &protection);
+                        *hook.original = reinterpret_cast<void*>(addressThunk->u1.Function);
+                        addressThunk->u1.Function = reinterpret_cast<ULONG_PTR>(hook.replacement);
+                        VirtualProtect(&addressThunk->u1.Function, sizeof(void*), protection, &protection);
+                    }
+                }
+            }
+        }
+    }
+
+    const bool importsPatched = (patchImports(), true);
+}
+
+#elif JUCE_LINUX
+//==============================================================================
+// Linux: these take the place of the pthread and libc functions, and forward to them
+namespace
+{
+    // backtrace() loads libgcc the first time it's used, which mustn't happen in a callback
+    const bool backtraceLoaded = []
+    {
+        void* frame = nullptr;
+        return backtrace(&frame, 1) >= 0;
+    }();
+}
+
+#define TWOSHOT_INTERPOSE(event, returnType, name, params, args) \
+    extern "C" returnType name params \
+    { \
+        using Function = returnType (*) params; \
+        static std::atomic<Function> next { nullptr }; \
+        auto function = next.load(std::memory_order_relaxed); \
+        if (function == nullptr) \
+        { \
+            function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, #name)); \
+            next.store(function, std::memory_order_relaxed); \
+        } \
+        TwoShotRealtimeGuard::record(Event::event, #name); \
+        return function args; \
+    }
+
+TWOSHOT_INTERPOSE(lock, int, pthread_mutex_lock, (pthread_mutex_t* mutex), (mutex))
+TWOSHOT_INTERPOSE(lock, int, pthread_rwlock_rdlock, (pthread_rwlock_t* rwlock), (rwlock))
+TWOSHOT_INTERPOSE(lock, int, pthread_rwlock_wrlock, (pthread_rwlock_t* rwlock), (rwlock))
+TWOSHOT_INTERPOSE(lock, int, pthread_cond_wait, (pthread_cond_t* condition, pthread_mutex_t* mutex), (condition, mutex))
+TWOSHOT_INTERPOSE(lock, int, pthread_cond_timedwait,
+    (pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time), (condition, mutex, time))
+TWOSHOT_INTERPOSE(systemCall, ssize_t, read, (int file, void* buffer, size_t numBytes), (file, buffer, numBytes))
+TWOSHOT_INTERPOSE(systemCall, ssize_t, write, (int file, const void* buffer, size_t numBytes), (file, buffer, numBytes))
+TWOSHOT_INTERPOSE(systemCall, int, nanosleep, (const struct timespec* time, struct timespec* remaining), (time, remaining))
+TWOSHOT_INTERPOSE(systemCall, int, usleep, (useconds_t microseconds), (microseconds))
+TWOSHOT_INTERPOSE(systemCall, void*, mmap,
+    (void* address, size_t length, int protection, int flags, int file, off_t offset),
+    (address, length, protection, flags, file, offset))
+TWOSHOT_INTERPOSE(systemCall, int, munmap, (void* address, size_t length), (address, length))
+TWOSHOT_INTERPOSE(systemCall, FILE*, fopen, (const char* path, const char* mode), (path, mode))
+
+#undef TWOSHOT_INTERPOSE
+#endif
+#endif
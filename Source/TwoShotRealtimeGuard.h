@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    TwoShotRealtimeGuard.h
+    Created: 17 Oct 2026 10:48:26pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Set to 1 to build the real-time guard in. The Debug and Profile configurations do,
+ * Release never does.
+ */
+#ifndef TWOSHOT_RT_GUARD
+ #define TWOSHOT_RT_GUARD 0
+#endif
+
+/**
+ * Catches the audio callback doing anything that can block: allocating or freeing memory,
+ * taking a lock, or making a system call.
+ *
+ * While a ScopedCallback exists on a thread, every one of those is counted against the
+ * stack it was made from, and createReport() lists them by call site. With trapping on,
+ * the first one aborts instead, so a debugger or crash dump stops right on it.
+ *
+ * Allocations are caught by replacing the global operator new and delete. Locks and system
+ * calls are caught by hooking the functions they go through: on Windows by patching this
+ * module's imports, so JUCE's CriticalSection and file classes are covered, and on Linux by
+ * interposing the pthread and libc functions, which only works when they resolve to this
+ * binary (a standalone build, not a plugin loaded with RTLD_LOCAL). The hooks are only built
+ * in when TWOSHOT_RT_GUARD is 1.
+ */
+class TwoShotRealtimeGuard
+{
+    public:
+        enum class Event
+        {
+            allocation,
+            deallocation,
+            lock,
+            systemCall
+        };
+
+        /** Marks the calling thread as being inside the audio callback while it exists */
+        class ScopedCallback
+        {
+            public:
+                ScopedCallback() noexcept;
+                ~ScopedCallback() noexcept;
+
+            private:
+                bool m_wasInCallback;
+
+                JUCE_DECLARE_NON_COPYABLE(ScopedCallback)
+        };
+
+        /** With trapping on, anything caught inside a callback aborts the process. Off by default */
+        static void setTrapping(bool shouldTrap) noexcept;
+
+        /** Called by the hooks. Counts the event if the calling thread is inside a callback */
+        static void record(Event event, const char* function) noexcept;
+
+        /** Lists what was caught, by call site with the stack of each. Must not be called from the audio thread */
+        static juce::String createReport();
+
+        /** Writes createReport() to a file, replacing what was there */
+        static bool writeReport(const juce::File& file);
+
+        /** Forgets everything caught so far */
+        static void reset() noexcept;
+
+        static constexpr int maxNumSites = 256;
+        static constexpr int maxNumFrames = 24;
+};
+
+#if TWOSHOT_RT_GUARD
+ /** Put at the top of the audio callback, to check everything it does from there on */
+ #define TWOSHOT_REALTIME_CALLBACK const TwoShotRealtimeGuard::ScopedCallback realtimeCallbackGuard;
+#else
+ #define TWOSHOT_REALTIME_CALLBACK
+#endif
@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    TwoShotReleasePool.cpp
+    Created: 17 Oct 2026 10:14:51am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotReleasePool.h"
+
+TwoShotReleasePool::TwoShotReleasePool() : juce::Thread("TwoShot release pool")
+{
+    startThread(2);
+}
+
+TwoShotReleasePool::~TwoShotReleasePool()
+{
+    stopThread(1000);
+
+    // nothing can be playing any more, so everything still waiting goes now
+    collectGarbage();
+    m_heldSets.clear();
+}
+
+bool TwoShotReleasePool::canRetire() const noexcept
+{
+    return m_fifo.getFreeSpace() > 0;
+}
+
+bool TwoShotReleasePool::retire(TwoShotSoundSet* set) noexcept
+{
+    int start1, size1, start2, size2;
+    m_fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 + size2 == 0)
+    {
+        return false;
+    }
+
+    m_retiredSets[(size_t) (size1 > 0 ? start1 : start2)] = set;
+    m_fifo.finishedWrite(1);
+    return true;
+}
+
+void TwoShotReleasePool::run()
+{
+    while (! threadShouldExit())
+    {
+        collectGarbage();
+        wait(100);
+    }
+}
+
+void TwoShotReleasePool::collectGarbage()
+{
+    int start1, size1, start2, size2;
+    m_fifo.prepareToRead(m_fifo.getNumReady(), start1, size1, start2, size2);
+
+    auto takeOver = [this](int start, int size)
+    {
+        for (int i = start; i < start + size; ++i)
+        {
+            // the array takes its own reference, so drop the one handed over by retire()
+            m_heldSets.add(m_retiredSets[(size_t) i]);
+            m_retiredSets[(size_t) i]->decReferenceCount();
+        }
+    };
+    takeOver(start1, size1);
+    takeOver(start2, size2);
+    m_fifo.finishedRead(size1 + size2);
+
+    for (int i = m_heldSets.size(); --i >= 0;)
+    {
+        if (m_heldSets.getObjectPointerUnchecked(i)->isUnused())
+        {
+            m_heldSets.remove(i);
+        }
+    }
+}
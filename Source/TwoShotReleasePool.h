@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    TwoShotReleasePool.h
+    Created: 17 Oct 2026 10:14:51am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TwoShotSoundSet.h"
+
+/**
+ * Deletes retired sound sets on a low priority thread, so that the audio thread
+ * never frees sample memory itself.
+ *
+ * The audio thread hands sets over through a lock-free fifo; the pool then holds
+ * on to each set until none of its sounds are being played any more.
+ */
+class TwoShotReleasePool : private juce::Thread
+{
+    public:
+        TwoShotReleasePool();
+        ~TwoShotReleasePool() override;
+
+        /**
+         * Returns true if there is room to retire another set.
+         * Safe to call from the audio thread.
+         */
+        bool canRetire() const noexcept;
+
+        /**
+         * Takes over one reference to the set, and releases it once it is unused.
+         * Lock-free and allocation-free, safe to call from the audio thread.
+         * @return false if the fifo was full, in which case the caller keeps its reference
+         */
+        bool retire(TwoShotSoundSet* set) noexcept;
+
+    private:
+        void run() override;
+        void collectGarbage();
+
+        static constexpr int fifoSize = 32;
+        juce::AbstractFifo m_fifo { fifoSize };
+        std::array<TwoShotSoundSet*, fifoSize> m_retiredSets {};
+        juce::ReferenceCountedArray<TwoShotSoundSet> m_heldSets;
+};
@@ -0,0 +1,503 @@
+/*
+  ==============================================================================
+
+    TwoShotRenderKernels.cpp
+    Created: 17 Oct 2026 4:02:10pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotRenderKernels.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+ #define TWOSHOT_KERNELS_SSE 1
+ // the plugin is built for plain SSE2, so the AVX2 kernels are compiled for it one function
+ // at a time and only called when the CPU has it
+ #define TWOSHOT_KERNELS_AVX2 1
+ #if JUCE_GCC || JUCE_CLANG
+  #define TWOSHOT_TARGET_AVX2 __attribute__ ((target ("avx2")))
+ #else
+  #define TWOSHOT_TARGET_AVX2
+ #endif
+#elif JUCE_ARM && defined (__ARM_NEON)
+ #include <arm_neon.h>
+ #define TWOSHOT_KERNELS_NEON 1
+#endif
+
+namespace
+{
+    constexpr int sincNumTaps = TwoShotRenderKernels::sincNumTaps;
+    constexpr int sincNumPhases = 128;
+
+    // quarter octave bands of increment, up to two octaves up
+    constexpr int sincNumBands = 9;
+
+    /**
+     * Kaiser-windowed sinc coefficients, sampled at sincNumPhases fractional positions.
+     * Each band's cutoff sits a quarter octave below the last, and every row is
+     * normalised to unity gain at DC.
+     */
+    struct SincTables
+    {
+        SincTables()
+        {
+            const double beta = 8.0;
+            const double halfWidth = TwoShotRenderKernels::numTapsAfter;
+
+            for (int band = 0; band < sincNumBands; ++band)
+            {
+                const double cutoff = 0.92 * std::pow(2.0, -band / 4.0);
+
+                for (int phase = 0; phase <= sincNumPhases; ++phase)
+                {
+                    const double frac = (double) phase / sincNumPhases;
+                    float* row = coefficients[band][phase];
+                    double sum = 0.0;
+
+                    for (int tap = 0; tap < sincNumTaps; ++tap)
+                    {
+                        const double x = tap - TwoShotRenderKernels::numTapsBefore - frac;
+                        const double r = jlimit(-1.0, 1.0, x / halfWidth);
+                        const double window = besselI0(beta * std::sqrt(1.0 - r * r)) / besselI0(beta);
+                        const double phi = MathConstants<double>::pi * cutoff * x;
+                        const double value = (std::abs(phi) < 1.0e-9 ? 1.0 : std::sin(phi) / phi) * window;
+
+                        row[tap] = (float) value;
+                        sum += value;
+                    }
+                    for (int tap = 0; tap < sincNumTaps; ++tap)
+                    {
+                        row[tap] = (float) (row[tap] / sum);
+                    }
+                }
+            }
+        }
+
+        static double besselI0(double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 32; ++k)
+            {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            return sum;
+        }
+
+        static int getBand(double increment) noexcept
+        {
+            // playing backwards aliases just as much as playing forwards
+            increment = std::abs(increment);
+            if (increment <= 1.0)
+            {
+                return 0;
+            }
+            return jmin(sincNumBands - 1, (int) std::ceil(4.0 * std::log2(increment) - 1.0e-6));
+        }
+
+        alignas(32) float coefficients[sincNumBands][sincNumPhases + 1][sincNumTaps];
+    };
+
+    // built once when the plugin is loaded, so the audio thread never computes a table
+    const SincTables sincTables;
+
+   #if TWOSHOT_KERNELS_AVX2
+    // asked once when the plugin is loaded, like the tables
+    const bool cpuHasAVX2 = juce::SystemStats::hasAVX2();
+
+    TWOSHOT_TARGET_AVX2 float dotSincAVX2(const float* src, const float* coefficients) noexcept
+    {
+        __m256 sum = _mm256_mul_ps(_mm256_loadu_ps(src), _mm256_load_ps(coefficients));
+        for (int tap = 8; tap < sincNumTaps; tap += 8)
+        {
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(src + tap), _mm256_load_ps(coefficients + tap)));
+        }
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        return _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+    }
+
+    /**
+     * The part of addLinear() that gathers eight samples at a time
+     * @return how many samples were rendered, a multiple of eight
+     */
+    template <int numChannels>
+    TWOSHOT_TARGET_AVX2 int addLinearAVX2(
+        float* const* out,
+        const float* const* in,
+        double position,
+        double increment,
+        const float* gains,
+        int numSamples) noexcept
+    {
+        const __m256d step = _mm256_set1_pd(increment);
+        const __m256d lanesLo = _mm256_mul_pd(_mm256_set_pd(3.0, 2.0, 1.0, 0.0), step);
+        const __m256d lanesHi = _mm256_mul_pd(_mm256_set_pd(7.0, 6.0, 5.0, 4.0), step);
+        const __m256i one = _mm256_set1_epi32(1);
+
+        int i = 0;
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const __m256d base = _mm256_set1_pd(position + i * increment);
+            const __m256d posLo = _mm256_add_pd(base, lanesLo);
+            const __m256d posHi = _mm256_add_pd(base, lanesHi);
+            const __m128i indexLo = _mm256_cvttpd_epi32(posLo);
+            const __m128i indexHi = _mm256_cvttpd_epi32(posHi);
+            const __m128 alphaLo = _mm256_cvtpd_ps(_mm256_sub_pd(posLo, _mm256_cvtepi32_pd(indexLo)));
+            const __m128 alphaHi = _mm256_cvtpd_ps(_mm256_sub_pd(posHi, _mm256_cvtepi32_pd(indexHi)));
+
+            const __m256i index = _mm256_inserti128_si256(_mm256_castsi128_si256(indexLo), indexHi, 1);
+            const __m256i nextIndex = _mm256_add_epi32(index, one);
+            const __m256 alpha = _mm256_insertf128_ps(_mm256_castps128_ps256(alphaLo), alphaHi, 1);
+            const __m256 gain = _mm256_loadu_ps(gains + i);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const __m256 a = _mm256_i32gather_ps(in[channel], index, 4);
+                const __m256 b = _mm256_i32gather_ps(in[channel], nextIndex, 4);
+                const __m256 value = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), alpha));
+                const __m256 mixed = _mm256_add_ps(_mm256_loadu_ps(out[channel] + i), _mm256_mul_ps(value, gain));
+                _mm256_storeu_ps(out[channel] + i, mixed);
+            }
+        }
+        return i;
+    }
+
+    /**
+     * The part of addStepped() that plays eight frames backwards at a time
+     * @return how many samples were rendered, a multiple of eight
+     */
+    TWOSHOT_TARGET_AVX2 int addReversedAVX2(float* dest, const float* src, const float* gains, int numSamples) noexcept
+    {
+        const __m256i reversed = _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+        int i = 0;
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const __m256 value = _mm256_permutevar8x32_ps(_mm256_loadu_ps(src - i - 7), reversed);
+            _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(dest + i), _mm256_mul_ps(value, _mm256_loadu_ps(gains + i))));
+        }
+        return i;
+    }
+   #endif
+
+    inline float dotSinc(const float* src, const float* coefficients) noexcept
+    {
+       #if TWOSHOT_KERNELS_SSE
+        __m128 sum = _mm_mul_ps(_mm_loadu_ps(src), _mm_load_ps(coefficients));
+        for (int tap = 4; tap < sincNumTaps; tap += 4)
+        {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src + tap), _mm_load_ps(coefficients + tap)));
+        }
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1)));
+       #elif TWOSHOT_KERNELS_NEON
+        float32x4_t sum = vmulq_f32(vld1q_f32(src), vld1q_f32(coefficients));
+        for (int tap = 4; tap < sincNumTaps; tap += 4)
+        {
+            sum = vmlaq_f32(sum, vld1q_f32(src + tap), vld1q_f32(coefficients + tap));
+        }
+        const float32x2_t pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+        return vget_lane_f32(vpadd_f32(pair, pair), 0);
+       #else
+        float sum = 0.0f;
+        for (int tap = 0; tap < sincNumTaps; ++tap)
+        {
+            sum += src[tap] * coefficients[tap];
+        }
+        return sum;
+       #endif
+    }
+
+    /**
+     * The whole of addSinc() for a given dot product, inlined into each version so the dot
+     * product is inlined into the loop
+     */
+    template <int numChannels, float (*dot)(const float*, const float*)>
+    forcedinline void addSincWith(
+        float* const* out,
+        const float* const* in,
+        double position,
+        double increment,
+        const float* gains,
+        int numSamples) noexcept
+    {
+        const auto& table = sincTables.coefficients[SincTables::getBand(increment)];
+        alignas(32) float coefficients[sincNumTaps];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double samplePosition = position + i * increment;
+            const int pos = (int) samplePosition;
+            const double phasePosition = (samplePosition - pos) * sincNumPhases;
+            const int phase = (int) phasePosition;
+            const float t = (float) (phasePosition - phase);
+
+            // the coefficients are interpolated between the two nearest phases once,
+            // then shared by both channels
+            const float* below = table[phase];
+            const float* above = table[phase + 1];
+            for (int tap = 0; tap < sincNumTaps; ++tap)
+            {
+                coefficients[tap] = below[tap] + (above[tap] - below[tap]) * t;
+            }
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                out[channel][i] += dot(in[channel] + pos - TwoShotRenderKernels::numTapsBefore, coefficients) * gains[i];
+            }
+        }
+    }
+
+   #if TWOSHOT_KERNELS_AVX2
+    template <int numChannels>
+    TWOSHOT_TARGET_AVX2 void addSincAVX2(
+        float* const* out,
+        const float* const* in,
+        double position,
+        double increment,
+        const float* gains,
+        int numSamples) noexcept
+    {
+        addSincWith<numChannels, dotSincAVX2>(out, in, position, increment, gains, numSamples);
+    }
+   #endif
+
+    template <int numChannels>
+    void addLinearScalar(
+        float* const* out,
+        const float* const* in,
+        double position,
+        double increment,
+        const float* gains,
+        int startSample,
+        int endSample) noexcept
+    {
+        for (int i = startSample; i < endSample; ++i)
+        {
+            const double samplePosition = position + i * increment;
+            const int pos = (int) samplePosition;
+            const float alpha = (float) (samplePosition - pos);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const float a = in[channel][pos];
+                out[channel][i] += (a + (in[channel][pos + 1] - a) * alpha) * gains[i];
+            }
+        }
+    }
+}
+
+template <int numChannels>
+void TwoShotRenderKernels::addLinear(
+    float* const* out,
+    const float* const* in,
+    double position,
+    double increment,
+    const float* gains,
+    int numSamples) noexcept
+{
+    static_assert(numChannels == 1 || numChannels == 2, "the voices render mono or stereo");
+
+    // positions are worked out from the start of the run rather than accumulated,
+    // so long notes don't drift however many samples they're rendered in
+    int i = 0;
+
+   #if TWOSHOT_KERNELS_AVX2
+    if (cpuHasAVX2)
+    {
+        i = addLinearAVX2<numChannels>(out, in, position, increment, gains, numSamples);
+    }
+   #endif
+
+   #if TWOSHOT_KERNELS_SSE
+    const __m128d step = _mm_set1_pd(increment);
+    const __m128d lanesLo = _mm_mul_pd(_mm_set_pd(1.0, 0.0), step);
+    const __m128d lanesHi = _mm_mul_pd(_mm_set_pd(3.0, 2.0), step);
+    alignas(16) int index[4];
+
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        const __m128d base = _mm_set1_pd(position + i * increment);
+        const __m128d posLo = _mm_add_pd(base, lanesLo);
+        const __m128d posHi = _mm_add_pd(base, lanesHi);
+        const __m128i indexLo = _mm_cvttpd_epi32(posLo);
+        const __m128i indexHi = _mm_cvttpd_epi32(posHi);
+        const __m128 alphaLo = _mm_cvtpd_ps(_mm_sub_pd(posLo, _mm_cvtepi32_pd(indexLo)));
+        const __m128 alphaHi = _mm_cvtpd_ps(_mm_sub_pd(posHi, _mm_cvtepi32_pd(indexHi)));
+        const __m128 alpha = _mm_movelh_ps(alphaLo, alphaHi);
+        const __m128 gain = _mm_loadu_ps(gains + i);
+
+        // SSE has no gather, so the loads are scalar and everything around them isn't
+        _mm_storel_epi64((__m128i*) index, indexLo);
+        _mm_storel_epi64((__m128i*) (index + 2), indexHi);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* src = in[channel];
+            const __m128 a = _mm_set_ps(src[index[3]], src[index[2]], src[index[1]], src[index[0]]);
+            const __m128 b = _mm_set_ps(src[index[3] + 1], src[index[2] + 1], src[index[1] + 1], src[index[0] + 1]);
+            const __m128 value = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), alpha));
+            const __m128 mixed = _mm_add_ps(_mm_loadu_ps(out[channel] + i), _mm_mul_ps(value, gain));
+            _mm_storeu_ps(out[channel] + i, mixed);
+        }
+    }
+   #elif TWOSHOT_KERNELS_NEON
+    int index[4];
+    float alphas[4], a[4], b[4];
+
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            const double samplePosition = position + (i + lane) * increment;
+            index[lane] = (int) samplePosition;
+            alphas[lane] = (float) (samplePosition - index[lane]);
+        }
+        const float32x4_t alpha = vld1q_f32(alphas);
+        const float32x4_t gain = vld1q_f32(gains + i);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* src = in[channel];
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                a[lane] = src[index[lane]];
+                b[lane] = src[index[lane] + 1];
+            }
+            const float32x4_t va = vld1q_f32(a);
+            const float32x4_t value = vmlaq_f32(va, vsubq_f32(vld1q_f32(b), va), alpha);
+            vst1q_f32(out[channel] + i, vmlaq_f32(vld1q_f32(out[channel] + i), value, gain));
+        }
+    }
+   #endif
+
+    addLinearScalar<numChannels>(out, in, position, increment, gains, i, numSamples);
+}
+
+template <int numChannels>
+void TwoShotRenderKernels::addHermite(
+    float* const* out,
+    const float* const* in,
+    double position,
+    double increment,
+    const float* gains,
+    int numSamples) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const double samplePosition = position + i * increment;
+        const int pos = (int) samplePosition;
+        const float t = (float) (samplePosition - pos);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* x = in[channel] + pos;
+            const float c1 = 0.5f * (x[1] - x[-1]);
+            const float c2 = x[-1] - 2.5f * x[0] + 2.0f * x[1] - 0.5f * x[2];
+            const float c3 = 0.5f * (x[2] - x[-1]) + 1.5f * (x[0] - x[1]);
+            out[channel][i] += (((c3 * t + c2) * t + c1) * t + x[0]) * gains[i];
+        }
+    }
+}
+
+template <int numChannels>
+void TwoShotRenderKernels::addSinc(
+    float* const* out,
+    const float* const* in,
+    double position,
+    double increment,
+    const float* gains,
+    int numSamples) noexcept
+{
+   #if TWOSHOT_KERNELS_AVX2
+    if (cpuHasAVX2)
+    {
+        addSincAVX2<numChannels>(out, in, position, increment, gains, numSamples);
+        return;
+    }
+   #endif
+
+    addSincWith<numChannels, dotSinc>(out, in, position, increment, gains, numSamples);
+}
+
+template <int numChannels>
+void TwoShotRenderKernels::addStepped(
+    float* const* out,
+    const float* const* in,
+    int index,
+    int step,
+    const float* gains,
+    int numSamples) noexcept
+{
+    static_assert(numChannels == 1 || numChannels == 2, "the voices render mono or stereo");
+
+    if (step == 1)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            juce::FloatVectorOperations::addWithMultiply(out[channel], in[channel] + index, gains, numSamples);
+        }
+        return;
+    }
+
+    // backwards at the root pitch, whole vectors are loaded from below and turned round
+    if (step == -1)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* src = in[channel] + index;
+            float* dest = out[channel];
+            int i = 0;
+
+           #if TWOSHOT_KERNELS_AVX2
+            if (cpuHasAVX2)
+            {
+                i = addReversedAVX2(dest, src, gains, numSamples);
+            }
+           #endif
+
+           #if TWOSHOT_KERNELS_SSE
+            for (; i + 4 <= numSamples; i += 4)
+            {
+                const __m128 loaded = _mm_loadu_ps(src - i - 3);
+                const __m128 value = _mm_shuffle_ps(loaded, loaded, _MM_SHUFFLE(0, 1, 2, 3));
+                _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), _mm_mul_ps(value, _mm_loadu_ps(gains + i))));
+            }
+           #elif TWOSHOT_KERNELS_NEON
+            for (; i + 4 <= numSamples; i += 4)
+            {
+                const float32x4_t pairs = vrev64q_f32(vld1q_f32(src - i - 3));
+                const float32x4_t value = vcombine_f32(vget_high_f32(pairs), vget_low_f32(pairs));
+                vst1q_f32(dest + i, vmlaq_f32(vld1q_f32(dest + i), value, vld1q_f32(gains + i)));
+            }
+           #endif
+
+            for (; i < numSamples; ++i)
+            {
+                dest[i] += src[-i] * gains[i];
+            }
+        }
+        return;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const int frame = index + i * step;
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            out[channel][i] += in[channel][frame] * gains[i];
+        }
+    }
+}
+
+template void TwoShotRenderKernels::addLinear<1>(float* const*, const float* const*, double, double, const float*, int) noexcept;
+template void TwoShotRenderKernels::addLinear<2>(float* const*, const float* const*, double, double, const float*, int) noexcept;
+template void TwoShotRenderKernels::addHermite<1>(float* const*, const float* const*, double, double, const float*, int) noexcept;
+template void TwoShotRenderKernels::addHermite<2>(float* const*, const float* const*, double, double, const float*, int) noexcept;
+template void TwoShotRenderKernels::addSinc<1>(float* const*, const float* const*, double, double, const float*, int) noexcept;
+template void TwoShotRenderKernels::addSinc<2>(float* const*, const float* const*, double, double, const float*, int) noexcept;
+template void TwoShotRenderKernels::addStepped<1>(float* const*, const float* const*, int, int, const float*, int) noexcept;
+template void TwoShotRenderKernels::addStepped<2>(float* const*, const float* const*, int, int, const float*, int) noexcept;
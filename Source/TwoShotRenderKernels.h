@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    TwoShotRenderKernels.h
+    Created: 17 Oct 2026 4:02:10pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * The inner loops of TwoShotVoice, vectorised with SSE or NEON depending on what the
+ * build targets, with a plain C++ fallback. On Intel, the ones that gain from AVX2 use it
+ * when the CPU has it.
+ *
+ * Every kernel renders a contiguous run of output samples, so the voice does its
+ * per-note decisions (loop mode, channel layout, end of sample) once per block.
+ * The increment may be negative, to play the source backwards, as long as every
+ * position stays at or above zero.
+ */
+struct TwoShotRenderKernels
+{
+    /** How the voices resample, from cheapest to cleanest */
+    enum class Interpolation
+    {
+        linear,
+        hermite,
+        sinc
+    };
+
+    /** The frames before and after (int) position that the widest kernel reads */
+    static constexpr int numTapsBefore = 15;
+    static constexpr int numTapsAfter = 16;
+
+    /**
+     * Resamples with linear interpolation and accumulates into the output:
+     * out[c][i] += lerp(in[c], position + i * increment) * gains[i]
+     *
+     * in[c] must be readable up to index (int) (position + (numSamples - 1) * increment) + 1,
+     * or (int) position + 1 when the increment is negative.
+     */
+    template <int numChannels>
+    static void addLinear(
+        float* const* out,
+        const float* const* in,
+        double position,
+        double increment,
+        const float* gains,
+        int numSamples) noexcept;
+
+    /**
+     * Resamples with 4-point, 3rd-order Hermite interpolation and accumulates into the output.
+     * in[c] must be readable from one frame before (int) position.
+     */
+    template <int numChannels>
+    static void addHermite(
+        float* const* out,
+        const float* const* in,
+        double position,
+        double increment,
+        const float* gains,
+        int numSamples) noexcept;
+
+    /**
+     * Resamples with a windowed sinc and accumulates into the output.
+     *
+     * The coefficients come from precomputed polyphase tables, one per quarter octave
+     * of increment either way, so pitching up lowers the cutoff instead of aliasing, while the cost
+     * stays at sincNumTaps multiply-adds per channel per sample.
+     * in[c] must be readable from numTapsBefore frames before (int) position.
+     */
+    template <int numChannels>
+    static void addSinc(
+        float* const* out,
+        const float* const* in,
+        double position,
+        double increment,
+        const float* gains,
+        int numSamples) noexcept;
+
+    static constexpr int sincNumTaps = numTapsBefore + numTapsAfter + 1;
+
+    /**
+     * Plays every step-th frame as it is and accumulates into the output:
+     * out[c][i] += in[c][index + i * step] * gains[i]
+     *
+     * This is what the interpolators come to when every position lands on a frame, without
+     * working out any fractions; at the root pitch it is one multiply-add straight down the
+     * source. The step may be negative, to play backwards.
+     */
+    template <int numChannels>
+    static void addStepped(
+        float* const* out,
+        const float* const* in,
+        int index,
+        int step,
+        const float* gains,
+        int numSamples) noexcept;
+
+    /**
+     * Returns the step addStepped() can play a run at instead of interpolating, or 0 if its
+     * positions don't all land on frames. The sinc filters out what would alias when it skips
+     * frames, so with sinc only single steps are played as they are.
+     */
+    static int getWholeStep(Interpolation interpolation, double position, double increment) noexcept
+    {
+        if (position != std::floor(position) || increment != std::floor(increment) || increment == 0.0)
+        {
+            return 0;
+        }
+
+        const int step = (int) increment;
+        return interpolation == Interpolation::sinc && std::abs(step) != 1 ? 0 : step;
+    }
+
+    /**
+     * Renders with the given interpolation, see addLinear(), addHermite() and addSinc(), or with
+     * addStepped() when there is nothing to interpolate
+     */
+    template <int numChannels>
+    static void add(
+        Interpolation interpolation,
+        float* const* out,
+        const float* const* in,
+        double position,
+        double increment,
+        const float* gains,
+        int numSamples) noexcept
+    {
+        if (const int step = getWholeStep(interpolation, position, increment))
+        {
+            addStepped<numChannels>(out, in, (int) position, step, gains, numSamples);
+            return;
+        }
+
+        switch (interpolation)
+        {
+            case Interpolation::hermite:
+                addHermite<numChannels>(out, in, position, increment, gains, numSamples);
+                break;
+            case Interpolation::sinc:
+                addSinc<numChannels>(out, in, position, increment, gains, numSamples);
+                break;
+            case Interpolation::linear:
+            default:
+                addLinear<numChannels>(out, in, position, increment, gains, numSamples);
+                break;
+        }
+    }
+};
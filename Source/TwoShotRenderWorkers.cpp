@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    TwoShotRenderWorkers.cpp
+    Created: 18 Oct 2026 2:41:07am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotRenderWorkers.h"
+#include "TwoShotRealtimeGuard.h"
+#include "TwoShotVoiceAllocator.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+namespace
+{
+    // how many times an idle worker checks for work before it starts yielding its core
+    constexpr int spinsBeforeYield = 2000;
+
+    /** Tells the core this is a spin-wait, so it saves power and doesn't starve its other hyperthread */
+    inline void pause() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && defined (_MSC_VER)
+        __yield();
+       #elif JUCE_ARM
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+
+    // a claim packs the job number, its number of voices, and the next voice to be claimed
+    constexpr juce::uint64 packClaim(juce::uint32 job, int numVoices, int next) noexcept
+    {
+        return ((juce::uint64) job << 32) | ((juce::uint64) numVoices << 16) | (juce::uint64) next;
+    }
+}
+
+/**
+* A thread that renders voices into a buffer of its own, whenever the audio thread hands out a job
+*/
+class TwoShotRenderWorkers::Worker : public juce::Thread
+{
+    public:
+        explicit Worker(TwoShotRenderWorkers& owner) :
+            juce::Thread("TwoShot render worker"),
+            m_buffer(2, maxSamplesPerJob),
+            m_owner(owner)
+        {
+        }
+
+        ~Worker() override
+        {
+            stopThread(1000);
+        }
+
+        /** The last job this worker rendered a voice of; its buffer holds that job's voices */
+        juce::uint32 m_lastJobRendered = 0;
+        juce::AudioBuffer<float> m_buffer;
+
+    private:
+        void run() override
+        {
+            const juce::ScopedNoDenormals noDenormals;
+            juce::uint32 lastJobSeen = 0;
+            auto lastWorkTime = juce::Time::getMillisecondCounter();
+            int numSpins = 0;
+
+            while (! threadShouldExit())
+            {
+                const auto job = (juce::uint32) (m_owner.m_claim.load(std::memory_order_acquire) >> 32);
+                if (job != lastJobSeen)
+                {
+                    lastJobSeen = job;
+                    renderClaimedVoices(job);
+                    lastWorkTime = juce::Time::getMillisecondCounter();
+                    numSpins = 0;
+                }
+                else if (++numSpins < spinsBeforeYield)
+                {
+                    pause();
+                }
+                else if (juce::Time::getMillisecondCounter() - lastWorkTime < (juce::uint32) idleTimeoutMs)
+                {
+                    juce::Thread::yield();
+                }
+                else
+                {
+                    wait(1);
+                }
+            }
+        }
+
+        void renderClaimedVoices(juce::uint32 job) noexcept
+        {
+            // the workers must keep to the same rules as the audio callback
+            TWOSHOT_REALTIME_CALLBACK
+
+            for (int index = m_owner.claimVoice(job); index >= 0; index = m_owner.claimVoice(job))
+            {
+                const int numChannels = m_owner.m_numChannels;
+                const int numSamples = m_owner.m_numSamples;
+
+                if (m_lastJobRendered != job)
+                {
+                    m_lastJobRendered = job;
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        juce::FloatVectorOperations::clear(m_buffer.getWritePointer(channel), numSamples);
+                    }
+                }
+
+                // refers to m_buffer's channels, nothing is allocated for it
+                juce::AudioBuffer<float> output(m_buffer.getArrayOfWritePointers(), numChannels, numSamples);
+                m_owner.m_voices[index]->renderNextBlock(output, 0, numSamples);
+                m_owner.m_numDone.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+        TwoShotRenderWorkers& m_owner;
+};
+
+TwoShotRenderWorkers::TwoShotRenderWorkers(int numThreads)
+{
+    const int numWorkers = juce::jlimit(0, maxNumThreads, numThreads);
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        m_workers.push_back(std::make_unique<Worker>(*this));
+    }
+    for (auto& worker : m_workers)
+    {
+        worker->startThread(juce::Thread::realtimeAudioPriority);
+    }
+}
+
+TwoShotRenderWorkers::~TwoShotRenderWorkers()
+{
+    // told all at once, so they stop together rather than one after another
+    for (auto& worker : m_workers)
+    {
+        worker->signalThreadShouldExit();
+    }
+    m_workers.clear();
+}
+
+void TwoShotRenderWorkers::renderVoices(
+    TwoShotVoice* const* voices,
+    int numVoices,
+    juce::AudioBuffer<float>& outputAudio,
+    int startSample,
+    int numSamples
+) noexcept
+{
+    for (int done = 0; done < numSamples; done += maxSamplesPerJob)
+    {
+        renderJob(voices, numVoices, outputAudio, startSample + done, juce::jmin(maxSamplesPerJob, numSamples - done));
+    }
+}
+
+/**
+* Hands the voices out, renders as many as the workers leave, then waits for the rest and adds them in
+*/
+void TwoShotRenderWorkers::renderJob(
+    TwoShotVoice* const* voices,
+    int numVoices,
+    juce::AudioBuffer<float>& outputAudio,
+    int startSample,
+    int numSamples
+) noexcept
+{
+    jassert(numVoices <= TwoShotVoiceAllocator::maxNumVoices && numSamples <= maxSamplesPerJob);
+
+    // no worker can be inside a job here, so its details can change
+    if (++m_job == 0)
+    {
+        ++m_job;
+    }
+    m_voices = voices;
+    m_numChannels = juce::jmin(2, outputAudio.getNumChannels());
+    m_numSamples = numSamples;
+    m_numDone.store(0, std::memory_order_relaxed);
+    m_claim.store(packClaim(m_job, numVoices, 0), std::memory_order_release);
+
+    int numRendered = 0;
+    for (int index = claimVoice(m_job); index >= 0; index = claimVoice(m_job))
+    {
+        voices[index]->renderNextBlock(outputAudio, startSample, numSamples);
+        ++numRendered;
+    }
+
+    // every voice has been claimed, so this only waits for ones a worker is rendering now
+    while (numRendered + m_numDone.load(std::memory_order_acquire) < numVoices)
+    {
+        pause();
+    }
+
+    for (auto& worker : m_workers)
+    {
+        if (worker->m_lastJobRendered != m_job)
+        {
+            continue;
+        }
+        for (int channel = 0; channel < m_numChannels; ++channel)
+        {
+            juce::FloatVectorOperations::add(
+                outputAudio.getWritePointer(channel, startSample),
+                worker->m_buffer.getReadPointer(channel),
+                numSamples
+            );
+        }
+    }
+}
+
+/**
+* Takes the next voice of the job that nobody has taken yet.
+* @return its index, or -1 if they are all taken or the job has moved on
+*/
+int TwoShotRenderWorkers::claimVoice(juce::uint32 job) noexcept
+{
+    auto claim = m_claim.load(std::memory_order_acquire);
+    for (;;)
+    {
+        const int numVoices = (int) ((claim >> 16) & 0xffff);
+        const int next = (int) (claim & 0xffff);
+        if ((juce::uint32) (claim >> 32) != job || next >= numVoices)
+        {
+            return -1;
+        }
+        if (m_claim.compare_exchange_weak(claim, claim + 1, std::memory_order_acquire))
+        {
+            return next;
+        }
+    }
+}
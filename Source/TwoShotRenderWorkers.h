@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    TwoShotRenderWorkers.h
+    Created: 18 Oct 2026 2:41:07am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TwoShotVoice.h"
+
+/**
+ * Shares the voices of a block between the audio thread and a few worker threads, so a
+ * dense patch can use more than one core.
+ *
+ * Each voice is claimed by whichever thread gets to it first, the audio thread included,
+ * so a worker that is asleep or descheduled only means the audio thread renders more voices
+ * itself. The audio thread renders straight into the output, and each worker into a buffer
+ * of its own, which are added in once every voice is done. Handing work out and waiting for
+ * it are spins on atomics: the audio thread never signals, locks or sleeps, and only ever
+ * waits for voices a worker is part way through.
+ *
+ * Workers spin between blocks while the host is playing, and drop back to polling once no
+ * work has come for idleTimeoutMs. Everything is allocated when the workers are created.
+ */
+class TwoShotRenderWorkers
+{
+    public:
+        /** Starts numThreads workers, which run until this is deleted */
+        explicit TwoShotRenderWorkers(int numThreads);
+        ~TwoShotRenderWorkers();
+
+        int getNumThreads() const noexcept { return (int) m_workers.size(); }
+
+        /** Returns true if this many voices over this many samples are worth sharing out */
+        static bool isWorthSharing(int numVoices, int numSamples) noexcept
+        {
+            return numVoices >= minVoicesToShare && numSamples >= minSamplesToShare;
+        }
+
+        /**
+         * Adds every voice into outputAudio, sharing them with the workers. Must only be called
+         * from the audio thread, with the voices' synthesiser locked so nothing else touches them.
+         */
+        void renderVoices(
+            TwoShotVoice* const* voices,
+            int numVoices,
+            juce::AudioBuffer<float>& outputAudio,
+            int startSample,
+            int numSamples
+        ) noexcept;
+
+        /** The workers the synth can be given, on top of the audio thread */
+        static constexpr int maxNumThreads = 7;
+
+        /** Fewer voices than this are quicker to render on the audio thread alone */
+        static constexpr int minVoicesToShare = 8;
+
+        /** Stretches between midi events shorter than this aren't worth waking the workers for */
+        static constexpr int minSamplesToShare = 32;
+
+        /** The longest stretch shared out at once; longer ones are split */
+        static constexpr int maxSamplesPerJob = 512;
+
+        /** How long the workers keep spinning after the last block before they poll instead */
+        static constexpr int idleTimeoutMs = 100;
+
+    private:
+        class Worker;
+
+        void renderJob(TwoShotVoice* const* voices, int numVoices, juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples) noexcept;
+        int claimVoice(juce::uint32 job) noexcept;
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+
+        // the job number in the top half, and its number of voices and the next one to claim in
+        // the bottom, so a worker can only claim voices from the job it read the details of
+        std::atomic<juce::uint64> m_claim { 0 };
+        std::atomic<int> m_numDone { 0 };
+        juce::uint32 m_job = 0;
+
+        // the job being rendered, only written by the audio thread between jobs
+        TwoShotVoice* const* m_voices = nullptr;
+        int m_numChannels = 0;
+        int m_numSamples = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TwoShotRenderWorkers)
+};
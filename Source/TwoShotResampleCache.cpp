@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    TwoShotResampleCache.cpp
+    Created: 18 Oct 2026 3:12:45am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotResampleCache.h"
+#include "TwoShotSynth.h"
+
+namespace
+{
+    // converted a chunk at a time, checking in between whether it is still wanted
+    constexpr int chunkSize = 65536;
+    constexpr int kernelBlockSize = 4096;
+
+    /**
+     * Resamples numOut frames of every channel with the voices' sinc kernel, starting at
+     * position in the source and moving on by increment per frame
+     */
+    template <int numChannels>
+    void resample(const TwoShotAudioData& source, juce::AudioBuffer<float>& dest, int destStart, double position, double increment, int numOut)
+    {
+        std::array<float, kernelBlockSize> gains;
+        gains.fill(1.0f);
+
+        const float* in[numChannels];
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            in[channel] = source.getReadPointer(channel, 0);
+        }
+
+        float* out[numChannels];
+        for (int done = 0; done < numOut; done += kernelBlockSize)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                out[channel] = dest.getWritePointer(channel, destStart + done);
+            }
+            TwoShotRenderKernels::addSinc<numChannels>(out, in, position + done * increment, increment, gains.data(),
+                                                       juce::jmin(kernelBlockSize, numOut - done));
+        }
+    }
+}
+
+TwoShotResampleCache::TwoShotResampleCache(TwoShotSynth& synth) :
+    juce::Thread("TwoShot resample cache"),
+    m_synth(synth)
+{
+    startThread(3);
+}
+
+TwoShotResampleCache::~TwoShotResampleCache()
+{
+    stop();
+}
+
+void TwoShotResampleCache::stop()
+{
+    stopThread(4000);
+}
+
+void TwoShotResampleCache::setHostSampleRate(const double hostSampleRate)
+{
+    m_hostSampleRate = hostSampleRate;
+    notify();
+}
+
+void TwoShotResampleCache::setEnabled(const bool shouldConvert)
+{
+    m_isEnabled = shouldConvert;
+    notify();
+}
+
+void TwoShotResampleCache::soundsChanged()
+{
+    notify();
+}
+
+void TwoShotResampleCache::run()
+{
+    while (! threadShouldExit())
+    {
+        // also polled, as the slicer and the UI replace the sounds without telling the cache
+        wait(50);
+
+        const double hostSampleRate = m_hostSampleRate;
+        TwoShotSoundSet::Ptr current = m_synth.getSoundSetToConvert();
+
+        if (current == nullptr || hostSampleRate <= 0)
+        {
+            continue;
+        }
+
+        // always converted from the original audio, which is also where turning conversion off goes back to
+        TwoShotSoundSet::Ptr source = &current->getSourceSet();
+        auto* sourceAudio = source->sounds.getFirst()->getAudioData();
+        const double sampleRate = m_isEnabled ? hostSampleRate : sourceAudio->sampleRate;
+
+        if (current->audioSampleRate == sampleRate)
+        {
+            continue;
+        }
+
+        TwoShotAudioData::Ptr audio = sourceAudio;
+        if (sampleRate != sourceAudio->sampleRate)
+        {
+            const Key key { sourceAudio->hash, juce::roundToInt(sampleRate) };
+
+            if (auto* converted = m_entries.find(key))
+            {
+                audio = *converted;
+            }
+            else
+            {
+                audio = convert(*sourceAudio, sampleRate, *current);
+                if (audio == nullptr)
+                {
+                    continue;
+                }
+                m_entries.insert(key, audio);
+            }
+        }
+
+        const juce::ScopedLock sl(m_synth.m_setLock);
+        if (m_synth.isCurrentSoundSet(*current))
+        {
+            m_synth.replaceCurrentSoundSet(createConvertedSet(*source, audio));
+        }
+    }
+}
+
+/**
+* Resamples the whole of the source to the new rate. The sinc lowers its cutoff when the
+* rate goes down, so nothing above the new Nyquist folds back
+* @return nullptr if current stopped being the synth's current sounds, or the thread is stopping
+*/
+TwoShotAudioData::Ptr TwoShotResampleCache::convert(const TwoShotAudioData& source, double sampleRate, const TwoShotSoundSet& current)
+{
+    const double increment = source.sampleRate / sampleRate;
+    const int numOut = (int) std::ceil(source.numSamples / increment);
+
+    juce::AudioBuffer<float> converted(source.numChannels, juce::jmax(1, numOut));
+    converted.clear();
+
+    for (int start = 0; start < numOut; start += chunkSize)
+    {
+        if (threadShouldExit())
+        {
+            return nullptr;
+        }
+
+        {
+            const juce::ScopedLock sl(m_synth.m_setLock);
+            if (! m_synth.isCurrentSoundSet(current))
+            {
+                return nullptr;
+            }
+        }
+
+        const int numToConvert = juce::jmin(chunkSize, numOut - start);
+        if (source.numChannels > 1)
+        {
+            resample<2>(source, converted, start, start * increment, increment, numToConvert);
+        }
+        else
+        {
+            resample<1>(source, converted, start, start * increment, increment, numToConvert);
+        }
+    }
+
+    return new TwoShotAudioData(std::move(converted), sampleRate, numOut);
+}
+
+/**
+* Builds sounds that play the same notes and regions as the source's, from audio at another rate
+*/
+TwoShotSoundSet* TwoShotResampleCache::createConvertedSet(TwoShotSoundSet& source, TwoShotAudioData::Ptr audio)
+{
+    const double ratio = audio->sampleRate / source.audioSampleRate;
+
+    auto* soundSet = new TwoShotSoundSet();
+    soundSet->audioSampleRate = audio->sampleRate;
+    soundSet->audioBpm = source.audioBpm;
+    soundSet->isLoop = source.isLoop;
+    soundSet->beatOffset = juce::roundToInt(source.beatOffset * ratio);
+
+    // back at the source's own rate, the set is an original again
+    if (audio != source.sounds.getFirst()->getAudioData())
+    {
+        soundSet->convertedFrom = &source;
+    }
+
+    for (auto* sound : source.sounds)
+    {
+        soundSet->sounds.add(sound->createConvertedCopy(audio));
+    }
+    return soundSet;
+}
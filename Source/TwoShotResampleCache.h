@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    TwoShotResampleCache.h
+    Created: 18 Oct 2026 3:12:45am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <tuple>
+#include "TwoShotSoundSet.h"
+#include "TwoShotLruCache.h"
+
+class TwoShotSynth;
+
+/**
+ * Converts audio loaded at a different sample rate from the host's to the host rate on a
+ * background thread, so notes at the root pitch step through it one sample at a time instead
+ * of being resampled by every voice.
+ *
+ * Whenever the sounds or the host rate change, the audio is run through the voices' windowed
+ * sinc once, and the synth is given the same sounds cut from the converted audio, which new
+ * notes play. The converted set keeps the one it was made from, so a later change of host rate
+ * converts from the original rather than converting twice. Recent results are kept in an LRU
+ * keyed by the source's hash and the host rate, so reloading a file or going back to a rate
+ * is free.
+ *
+ * Only audio held in memory is converted, see TwoShotAudioData::isStreamed().
+ */
+class TwoShotResampleCache : private juce::Thread
+{
+    public:
+        explicit TwoShotResampleCache(TwoShotSynth& synth);
+        ~TwoShotResampleCache() override;
+
+        /** Tells the cache the rate the voices play at */
+        void setHostSampleRate(const double hostSampleRate);
+
+        /** Turns conversion on or off. Turned off, converted sounds go back to the original audio */
+        void setEnabled(const bool shouldConvert);
+
+        /** Tells the cache the synth has new sounds, so they are converted without waiting */
+        void soundsChanged();
+
+        /** Stops the thread, abandoning any conversion in progress */
+        void stop();
+
+        /** The most converted copies of audio kept at once */
+        static constexpr int maxNumEntries = 4;
+
+    private:
+        // the source's hash and the rate it was converted to
+        using Key = std::tuple<juce::uint64, int>;
+
+        void run() override;
+        TwoShotAudioData::Ptr convert(const TwoShotAudioData& source, double sampleRate, const TwoShotSoundSet& current);
+        static TwoShotSoundSet* createConvertedSet(TwoShotSoundSet& source, TwoShotAudioData::Ptr audio);
+
+        TwoShotSynth& m_synth;
+        std::atomic<double> m_hostSampleRate { 0 };
+        std::atomic<bool> m_isEnabled { true };
+
+        TwoShotLruCache<Key, TwoShotAudioData::Ptr> m_entries { maxNumEntries };
+};
@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    TwoShotSlicer.cpp
+    Created: 18 Oct 2026 12:05:44am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotSlicer.h"
+#include "TwoShotSynth.h"
+#include <numeric>
+
+namespace
+{
+    constexpr int fftOrder = 10;
+    constexpr int fftSize = 1 << fftOrder;
+    constexpr int hopSize = fftSize / 4;
+    constexpr int numBins = fftSize / 2 + 1;
+
+    // a frame is an onset if it is the largest flux within peakRadius frames, and stands
+    // out from the mean over averageRadius frames by more than threshold of the largest flux
+    constexpr int peakRadius = 3;
+    constexpr int averageRadius = 16;
+    constexpr float threshold = 0.08f;
+    constexpr double minOnsetSpacingSeconds = 0.05;
+}
+
+TwoShotSlicer::TwoShotSlicer(TwoShotSynth& synth) :
+    juce::Thread("TwoShot slicer"),
+    m_synth(synth)
+{
+    startThread(3);
+}
+
+TwoShotSlicer::~TwoShotSlicer()
+{
+    stop();
+}
+
+void TwoShotSlicer::stop()
+{
+    stopThread(4000);
+}
+
+bool TwoShotSlicer::findOnsets(const juce::uint64 hash, juce::Array<int>& onsets)
+{
+    const juce::ScopedLock sl(m_entryLock);
+    if (auto* found = m_entries.find(hash))
+    {
+        onsets = *found;
+        return true;
+    }
+    return false;
+}
+
+void TwoShotSlicer::analyse(TwoShotAudioData::Ptr audioData)
+{
+    jassert(! audioData->isStreamed());
+
+    const int numSamples = audioData->numSamples;
+    juce::AudioBuffer<float> mono(1, juce::jmax(1, numSamples));
+    mono.clear();
+    for (int channel = 0; channel < audioData->numChannels; ++channel)
+    {
+        mono.addFrom(0, 0, audioData->getReadPointer(channel, 0), numSamples, 1.0f / audioData->numChannels);
+    }
+
+    {
+        const juce::ScopedLock sl(m_requestLock);
+        m_request = Request { audioData, std::move(mono) };
+    }
+    notify();
+}
+
+void TwoShotSlicer::run()
+{
+    while (! threadShouldExit())
+    {
+        auto request = takeRequest();
+        if (! request.has_value())
+        {
+            wait(-1);
+            continue;
+        }
+
+        const auto& audioData = *request->audioData;
+        auto onsets = detectOnsets(request->mono.getReadPointer(0), audioData.numSamples, audioData.sampleRate);
+
+        if (threadShouldExit())
+        {
+            return;
+        }
+
+        {
+            const juce::ScopedLock sl(m_entryLock);
+            m_entries.insert(audioData.hash, onsets);
+        }
+
+        m_synth.sliceAtOnsets(audioData, onsets);
+    }
+}
+
+std::optional<TwoShotSlicer::Request> TwoShotSlicer::takeRequest()
+{
+    const juce::ScopedLock sl(m_requestLock);
+    std::optional<Request> request;
+    std::swap(request, m_request);
+    return request;
+}
+
+juce::Array<int> TwoShotSlicer::detectOnsets(const float* samples, const int numSamples, const double sampleRate)
+{
+    juce::dsp::FFT fft(fftOrder);
+    juce::dsp::WindowingFunction<float> window((size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false);
+
+    // the transform works in place, on twice the frame size
+    std::vector<float> frame((size_t) (2 * fftSize));
+    std::vector<float> magnitudes((size_t) numBins, 0.0f);
+    std::vector<float> previousMagnitudes((size_t) numBins, 0.0f);
+
+    const int numFrames = juce::jmax(0, (numSamples + hopSize - 1) / hopSize);
+    std::vector<float> flux((size_t) numFrames, 0.0f);
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        const int start = i * hopSize;
+        const int numToCopy = juce::jmin(fftSize, numSamples - start);
+
+        juce::FloatVectorOperations::clear(frame.data(), (int) frame.size());
+        juce::FloatVectorOperations::copy(frame.data(), samples + start, numToCopy);
+        window.multiplyWithWindowingTable(frame.data(), (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform(frame.data());
+
+        // the rise in each bin since the last frame, ignoring the bins that fell
+        juce::FloatVectorOperations::copy(magnitudes.data(), frame.data(), numBins);
+        juce::FloatVectorOperations::subtract(frame.data(), magnitudes.data(), previousMagnitudes.data(), numBins);
+        juce::FloatVectorOperations::max(frame.data(), frame.data(), 0.0f, numBins);
+        flux[(size_t) i] = std::accumulate(frame.begin(), frame.begin() + numBins, 0.0f);
+
+        std::swap(magnitudes, previousMagnitudes);
+    }
+
+    juce::Array<int> onsets;
+    if (numFrames == 0)
+    {
+        return onsets;
+    }
+
+    const float maxFlux = juce::FloatVectorOperations::findMaximum(flux.data(), numFrames);
+    if (maxFlux <= 0)
+    {
+        return onsets;
+    }
+    juce::FloatVectorOperations::multiply(flux.data(), 1.0f / maxFlux, numFrames);
+
+    const int minSpacing = juce::jmax(1, juce::roundToInt(minOnsetSpacingSeconds * sampleRate / hopSize));
+    int lastOnsetFrame = -minSpacing;
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        const float value = flux[(size_t) i];
+
+        const int peakStart = juce::jmax(0, i - peakRadius);
+        const int peakEnd = juce::jmin(numFrames, i + peakRadius + 1);
+        if (value < juce::FloatVectorOperations::findMaximum(flux.data() + peakStart, peakEnd - peakStart))
+        {
+            continue;
+        }
+
+        const int averageStart = juce::jmax(0, i - averageRadius);
+        const int averageEnd = juce::jmin(numFrames, i + averageRadius + 1);
+        const float mean = std::accumulate(flux.begin() + averageStart, flux.begin() + averageEnd, 0.0f) / (averageEnd - averageStart);
+
+        if (value > mean + threshold && i - lastOnsetFrame >= minSpacing)
+        {
+            // the flux peaks as the hit reaches the middle of the window
+            onsets.add(juce::jmin(numSamples - 1, i * hopSize + fftSize / 2 - hopSize));
+            lastOnsetFrame = i;
+        }
+    }
+    return onsets;
+}
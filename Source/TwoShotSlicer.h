@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    TwoShotSlicer.h
+    Created: 18 Oct 2026 12:05:44am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TwoShotSound.h"
+#include "TwoShotLruCache.h"
+
+class TwoShotSynth;
+
+/**
+ * Finds the transients in LOOP MODE audio, so it can be cut at its hits rather than
+ * every bar.
+ *
+ * Onsets are found on a background thread with a spectral flux pass: the audio is cut into
+ * overlapping windows, and a hit shows up as a jump in magnitude across the spectrum from one
+ * window to the next. The synth slices the loop into bars straight away, and again at the
+ * onsets once they are ready.
+ *
+ * The onsets are kept in an LRU keyed by the audio's hash, so loading the same file again
+ * costs nothing. They are sample positions in the audio played forwards, and don't depend on
+ * its tempo; the synth snaps them to its grid.
+ */
+class TwoShotSlicer : private juce::Thread
+{
+    public:
+        /** How LOOP MODE audio is cut into sounds */
+        enum class Slicing
+        {
+            bars,
+            transients
+        };
+
+        explicit TwoShotSlicer(TwoShotSynth& synth);
+        ~TwoShotSlicer() override;
+
+        /** Copies the onsets found in the audio with this hash into onsets, if they have been found already */
+        bool findOnsets(const juce::uint64 hash, juce::Array<int>& onsets);
+
+        /** Queues the audio to have its onsets found, replacing any audio queued before it */
+        void analyse(TwoShotAudioData::Ptr audioData);
+
+        /** Stops the thread, abandoning any analysis in progress */
+        void stop();
+
+        /**
+         * Returns the sample positions of the onsets in some mono audio, in order.
+         * Public so the benchmarks can time it without a thread
+         */
+        static juce::Array<int> detectOnsets(const float* samples, const int numSamples, const double sampleRate);
+
+        /** The most sources whose onsets are kept at once */
+        static constexpr int maxNumEntries = 64;
+
+    private:
+        struct Request
+        {
+            TwoShotAudioData::Ptr audioData;
+            juce::AudioBuffer<float> mono;
+        };
+
+        void run() override;
+        std::optional<Request> takeRequest();
+
+        TwoShotSynth& m_synth;
+
+        juce::CriticalSection m_requestLock;
+        std::optional<Request> m_request;
+
+        juce::CriticalSection m_entryLock;
+        TwoShotLruCache<juce::uint64, juce::Array<int>> m_entries { maxNumEntries };
+};
@@ -12,77 +12,145 @@ Author:  Deuel Lab
 
 #include "TwoShotSound.h"
 
-TwoShotSound::TwoShotSound(
-    AudioBuffer<float> & buffer,
-    double bufferSampleRate,
-    const BigInteger& notes,
-    int midiNoteForNormalPitch,
-    double attackTimeSecs,
-    double releaseTimeSecs,
-    double maxSampleLengthSeconds)
+TwoShotAudioData::TwoShotAudioData(AudioBuffer<float>&& source, double sourceSampleRate, int maxNumSamples)
     :
-    sourceSampleRate(bufferSampleRate),
-    midiNotes(notes),
-    midiRootNote(midiNoteForNormalPitch)
+    sampleRate(sourceSampleRate),
+    numSamples(jmin(source.getNumSamples(), maxNumSamples)),
+    numChannels(jmin(2, source.getNumChannels()))
 {
-    if (sourceSampleRate > 0 && buffer.getNumSamples() > 0)
+    static_assert(guardSamples > TwoShotRenderKernels::numTapsBefore
+                  && guardSamples > TwoShotRenderKernels::numTapsAfter + 1,
+                  "the interpolators would read outside the buffer");
+
+    buffer.setSize(numChannels, guardSamples + numSamples + guardSamples);
+    buffer.clear();
+    for (int channel = 0; channel < numChannels; ++channel)
     {
-        length = jmin((int)buffer.getNumSamples(),
-            (int)(maxSampleLengthSeconds * sourceSampleRate));
+        buffer.copyFrom(channel, guardSamples, source, channel, 0, numSamples);
+    }
 
-        data.reset(new AudioBuffer<float>(jmin(2, (int)buffer.getNumChannels()), length + 4));
-        data.get()->clear();
-        for (int i = 0; i < buffer.getNumChannels(); ++i)
+    // FNV-1a over the samples, so the same audio is recognised however it was loaded
+    hash = 14695981039346656037ull;
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* words = reinterpret_cast<const uint32*>(getReadPointer(channel, 0));
+        for (int i = 0; i < numSamples; ++i)
         {
-            data.get()->copyFrom(i, 0, buffer.getReadPointer(i), length);
+            hash = (hash ^ words[i]) * 1099511628211ull;
         }
-
-        params.attack = static_cast<float> (attackTimeSecs);
-        params.release = static_cast<float> (releaseTimeSecs);
     }
 }
 
+TwoShotAudioData::TwoShotAudioData(std::unique_ptr<AudioFormatReader> sourceReader)
+    :
+    reader(std::move(sourceReader)),
+    sampleRate(reader->sampleRate),
+    numSamples((int) reader->lengthInSamples),
+    numChannels(jmin(2, (int) reader->numChannels))
+{
+}
+
+void TwoShotAudioData::readFromFile(AudioBuffer<float>& dest, int destStart, int64 sourceStart, int numSamplesToRead)
+{
+    jassert(isStreamed());
+    reader->read(&dest, destStart, numSamplesToRead, sourceStart, true, true);
+}
+
+TwoShotSound::TwoShotSound(
+    TwoShotAudioData::Ptr source,
+    const BigInteger& notes,
+    int midiNoteForNormalPitch)
+    :
+    sourceSampleRate(source->sampleRate),
+    midiNotes(notes),
+    midiRootNote(midiNoteForNormalPitch),
+    length(source->numSamples),
+    data(source)
+{
+    loadStreamHeads();
+}
+
 TwoShotSound::TwoShotSound(
-    AudioBuffer<float> & buffer,
-    double bufferSampleRate,
+    TwoShotAudioData::Ptr source,
     const BigInteger& notes,
     int midiNoteForNormalPitch,
     int startSample,
     int numSamples,
-    int fadeLength,
-    double attackTimeSecs,
-    double releaseTimeSecs,
-    double maxSampleLengthSeconds)
+    int numFadeSamples)
     :
-    sourceSampleRate(bufferSampleRate),
+    sourceSampleRate(source->sampleRate),
     midiNotes(notes),
-    midiRootNote(midiNoteForNormalPitch)
+    midiRootNote(midiNoteForNormalPitch),
+    offset(startSample),
+    length(jmin(numSamples, source->numSamples - startSample)),
+    fadeLength(numFadeSamples),
+    data(source)
 {
-    if (sourceSampleRate > 0 && buffer.getNumSamples() > 0)
-    {
-        length = jmin((int)numSamples,
-            (int)(maxSampleLengthSeconds * sourceSampleRate));
-        data.reset(new AudioBuffer<float>(jmin(2, (int)buffer.getNumChannels()), length + 4));
-        data.get()->clear();
-        for (int i = 0; i < buffer.getNumChannels(); ++i)
-        {
-            data.get()->copyFrom(i, 0,  buffer, i, startSample, length);
-        }
-        data.get()->applyGainRamp(
-            data.get()->getNumSamples() - (fadeLength + 4), 
-            fadeLength, 
-            1.0, 
-            0
-        );
-        params.attack = static_cast<float> (attackTimeSecs);
-        params.release = static_cast<float> (releaseTimeSecs);
-    }
+    loadStreamHeads();
 }
 
 TwoShotSound::~TwoShotSound()
 {
 }
 
+TwoShotSound* TwoShotSound::createStretchedCopy(
+    TwoShotAudioData::Ptr stretchedAudio,
+    int startSample,
+    int numSamples,
+    double tempo) const
+{
+    auto* copy = new TwoShotSound(
+        stretchedAudio,
+        midiNotes,
+        midiRootNote,
+        startSample,
+        numSamples,
+        fadeLength);
+    copy->tempoRatio = tempo;
+    copy->original = this;
+    return copy;
+}
+
+TwoShotSound* TwoShotSound::createConvertedCopy(TwoShotAudioData::Ptr convertedAudio) const
+{
+    // the ends are rounded the same way for every slice, so neighbouring slices still meet
+    const double ratio = convertedAudio->sampleRate / sourceSampleRate;
+    const int startSample = roundToInt(offset * ratio);
+    const int endSample = roundToInt((offset + length) * ratio);
+
+    auto* copy = new TwoShotSound(
+        convertedAudio,
+        midiNotes,
+        midiRootNote,
+        startSample,
+        endSample - startSample,
+        roundToInt(fadeLength * ratio));
+    return copy;
+}
+
+/**
+* Preloads enough of a streamed region for the disk thread to catch up after a note starts.
+* The reversed head is the end of the region, so reversing never has to touch the disk.
+*/
+void TwoShotSound::loadStreamHeads()
+{
+    if (! data->isStreamed())
+    {
+        return;
+    }
+
+    streamHeadLength = jmin(length, (int) (streamHeadSeconds * sourceSampleRate));
+
+    streamHead.setSize(2, streamHeadLength + TwoShotAudioData::guardSamples);
+    streamHead.clear();
+    data->readFromFile(streamHead, 0, offset, streamHeadLength);
+
+    streamHeadReversed.setSize(2, streamHeadLength + TwoShotAudioData::guardSamples);
+    streamHeadReversed.clear();
+    data->readFromFile(streamHeadReversed, 0, offset + length - streamHeadLength, streamHeadLength);
+    streamHeadReversed.reverse(0, streamHeadLength);
+}
+
 bool TwoShotSound::appliesToNote(int midiNoteNumber)
 {
     return midiNotes[midiNoteNumber];
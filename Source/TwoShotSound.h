@@ -13,63 +13,134 @@ Author:  Deuel Lab
 #include <JuceHeader.h>
 #include "TwoShotVoice.h"
 
+/**
+ * Audio shared by every TwoShotSound cut from it.
+ *
+ * Either the whole file is decoded into memory, or, for long files, only the
+ * reader is kept and the voices stream from disk (see TwoShotDiskStream).
+ * A decoded buffer is padded with silence at both ends, so the voices can
+ * interpolate past the first and last samples without bounds checks.
+ *
+ * The audio is never changed once it is built: reversing is a direction the
+ * voices play it in, so notes going either way can share it, and the background
+ * threads that stretch or convert it read it while the voices are playing it.
+ */
+class TwoShotAudioData : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<TwoShotAudioData>;
+
+    /** Takes over the audio, keeping at most the first two channels and maxNumSamples samples */
+    TwoShotAudioData(AudioBuffer<float>&& source, double sourceSampleRate, int maxNumSamples);
+
+    /** Keeps only the reader, the audio will be streamed from disk while playing */
+    explicit TwoShotAudioData(std::unique_ptr<AudioFormatReader> sourceReader);
+
+    /**
+     * Returns true if the audio is read from disk as it plays. Streamed audio is never
+     * stretched, converted or sliced ahead of time, as that would load the whole file into memory
+     */
+    bool isStreamed() const noexcept { return reader != nullptr; }
+
+    /** Returns a pointer to a sample of decoded audio, skipping the leading padding */
+    const float* getReadPointer(int channel, int sample) const noexcept
+    {
+        return buffer.getReadPointer(channel, guardSamples + sample);
+    }
+
+    /**
+     * Reads from the file of streamed audio into dest. Only one thread may read at a time:
+     * the loader while building the sounds, then the disk streaming thread.
+     */
+    void readFromFile(AudioBuffer<float>& dest, int destStart, int64 sourceStart, int numSamplesToRead);
+
+    AudioBuffer<float> buffer;
+    std::unique_ptr<AudioFormatReader> reader;
+    double sampleRate;
+    int numSamples = 0;
+    int numChannels = 0;
+
+    /** Identifies decoded audio by its content, 0 for streamed audio */
+    uint64 hash = 0;
+
+    /** The silent samples either side of the audio, enough for the widest interpolation kernel */
+    static constexpr int guardSamples = 32;
+
+    JUCE_LEAK_DETECTOR(TwoShotAudioData)
+};
+
 class TwoShotSound : public SynthesiserSound
 {
 public:
     //==============================================================================
-    /** Creates a sampled sound from an audio reader.
-        This will attempt to load the audio from the source into memory and store
-        it in this object.
-        @param name         a name for the sample
-        @param source       the audio to load. This object can be safely deleted by the
-                            caller after this constructor returns
+    /** Creates a sound that plays the whole of the shared audio.
+        @param source       the audio to play. The sound keeps a reference to it, nothing is copied
         @param midiNotes    the set of midi keys that this sound should be played on. This
                             is used by the SynthesiserSound::appliesToNote() method
         @param midiNoteForNormalPitch   the midi note at which the sample should be played
                                         with its natural rate. All other notes will be pitched
                                         up or down relative to this one
-        @param attackTimeSecs   the attack (fade-in) time, in seconds
-        @param releaseTimeSecs  the decay (fade-out) time, in seconds
-        @param maxSampleLengthSeconds   a maximum length of audio to read from the audio
-                                        source, in seconds
     */
     TwoShotSound(
-        AudioBuffer<float> & buffer,
-        double bufferSampleRate,
+        TwoShotAudioData::Ptr source,
         const BigInteger& midiNotes,
-        int midiNoteForNormalPitch,
-        double attackTimeSecs,
-        double releaseTimeSecs,
-        double maxSampleLengthSeconds);
+        int midiNoteForNormalPitch);
 
+    /** Creates a sound that plays a slice of the shared audio.
+        @param startSample  where the slice starts in the source
+        @param numSamples   the length of the slice
+        @param fadeLength   the number of samples at the end of the slice that are faded
+                            out while rendering
+    */
     TwoShotSound(
-        AudioBuffer<float>& buffer,
-        double bufferSampleRate,
+        TwoShotAudioData::Ptr source,
         const BigInteger& midiNotes,
         int midiNoteForNormalPitch,
         int startSample,
         int numSamples,
-        int fadeLength,
-        double attackTimeSecs,
-        double releaseTimeSecs,
-        double maxSampleLengthSeconds);
+        int fadeLength);
 
     /** Destructor. */
     ~TwoShotSound() override;
 
     //==============================================================================
 
-    /** Returns the audio sample data.
-        This could return nullptr if there was a problem loading the data.
-    */
-    AudioBuffer<float>* getAudioData() const noexcept { return data.get(); }
+    /** Returns the audio this sound plays a region of. */
+    TwoShotAudioData* getAudioData() const noexcept { return data.get(); }
 
-    //==============================================================================
-    /** Changes the parameters of the ADSR envelope which will be applied to the sample. */
-    void setEnvelopeParameters(ADSR::Parameters parametersToUse) { params = parametersToUse; }
+    /** Returns true if this sound has to be streamed from disk past its preloaded head */
+    bool isStreamed() const noexcept { return data->isStreamed() && length > streamHeadLength; }
+
+    /** Returns where this sound's region starts in the shared audio */
+    int getRegionStart() const noexcept { return offset; }
+
+    /** Returns the length of this sound's region */
+    int getRegionLength() const noexcept { return length; }
+
+    /**
+     * Creates a sound that plays the same notes from a time-stretched copy of this sound's region.
+     * @param tempo     the speed the copy was stretched to, where 2 is twice as fast
+     */
+    TwoShotSound* createStretchedCopy(TwoShotAudioData::Ptr stretchedAudio, int startSample, int numSamples, double tempo) const;
 
+    /**
+     * Creates a sound that plays the same notes and region from a copy of the audio at another
+     * sample rate, with the region and fade scaled to match
+     */
+    TwoShotSound* createConvertedCopy(TwoShotAudioData::Ptr convertedAudio) const;
+
+    /** Returns the sound this one is a stretched copy of, or this sound if it isn't a copy */
+    const TwoShotSound* getOriginal() const noexcept { return original != nullptr ? original : this; }
+
+    //==============================================================================
     void setMidiNotes(BigInteger midiNotes, int midiRootNote);
 
+    /** Returns the midi keys this sound is played on */
+    const BigInteger& getMidiNotes() const noexcept { return midiNotes; }
+
+    /** How much of a streamed sound is kept in memory */
+    static constexpr double streamHeadSeconds = 0.5;
+
     //==============================================================================
     bool appliesToNote(int midiNoteNumber) override;
     bool appliesToChannel(int midiChannel) override;
@@ -81,10 +152,20 @@ private:
     double sourceSampleRate;
     BigInteger midiNotes;
     int midiRootNote = 0;
+    int offset = 0;
     int length = 0;
-    std::unique_ptr<AudioBuffer<float>> data;
-
-    ADSR::Parameters params;
+    int fadeLength = 0;
+    TwoShotAudioData::Ptr data;
+
+    // for stretched copies, the tempo baked into the audio and the sound it was made from
+    double tempoRatio = 1.0;
+    const TwoShotSound* original = nullptr;
+
+    // for streamed audio, the start of the region in playback order, both ways round
+    void loadStreamHeads();
+    AudioBuffer<float> streamHead;
+    AudioBuffer<float> streamHeadReversed;
+    int streamHeadLength = 0;
 
     JUCE_LEAK_DETECTOR(TwoShotSound)
 };
\ No newline at end of file
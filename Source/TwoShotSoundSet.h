@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    TwoShotSoundSet.h
+    Created: 17 Oct 2026 10:12:04am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TwoShotSound.h"
+
+/**
+ * The complete set of sounds built from one piece of audio.
+ *
+ * A set is built off the audio thread (see TwoShotLoader), handed to the audio
+ * thread with a single atomic pointer swap, and deleted by the TwoShotReleasePool
+ * once no voice is playing any of its sounds any more.
+ */
+struct TwoShotSoundSet : public juce::ReferenceCountedObject
+{
+    using Ptr = juce::ReferenceCountedObjectPtr<TwoShotSoundSet>;
+
+    /**
+     * Returns true when nothing but this set holds on to its sounds,
+     * i.e. the synth has dropped them and no voice is still playing one.
+     */
+    bool isUnused() const
+    {
+        for (auto* sound : sounds)
+        {
+            if (sound->getReferenceCount() > 1)
+            {
+                return false;
+            }
+        }
+
+        // voices move from the original sounds onto stretched ones while they play
+        return stretchedFrom == nullptr || stretchedFrom->isUnused();
+    }
+
+    juce::ReferenceCountedArray<TwoShotSound> sounds;
+    double audioSampleRate = 44100;
+    double audioBpm = 120;
+    bool isLoop = false;
+    /** Where the loop's beat grid starts, in samples into the audio played forwards */
+    int beatOffset = 0;
+
+    /** For a set of time-stretched copies, the set they were made from */
+    Ptr stretchedFrom;
+
+    /** For a set converted to the host's sample rate, the set at the audio's own rate it was made from */
+    Ptr convertedFrom;
+
+    /** Returns the set at the audio's own rate these sounds were cut from, which may be this one */
+    TwoShotSoundSet& getSourceSet() noexcept { return convertedFrom != nullptr ? *convertedFrom : *this; }
+
+    JUCE_LEAK_DETECTOR(TwoShotSoundSet)
+};
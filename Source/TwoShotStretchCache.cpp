@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    TwoShotStretchCache.cpp
+    Created: 17 Oct 2026 6:40:03pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotStretchCache.h"
+#include "TwoShotSynth.h"
+
+namespace
+{
+    /**
+     * Runs one region through the stretcher, then pushes silence until all of it has come out,
+     * and writes numOut stretched frames to dest. The channels go in and come out planar, so
+     * the only copies are the ones SoundTouch makes into and out of its own buffers.
+     */
+    void stretchRegion(
+        soundtouch::TDStretch& stretcher,
+        const TwoShotAudioData& source,
+        int regionStart,
+        int numIn,
+        juce::AudioBuffer<float>& dest,
+        int destStart,
+        int numOut,
+        std::vector<float>& silence)
+    {
+        constexpr int chunkSize = 4096;
+        const int numChannels = source.numChannels;
+        silence.assign((size_t) chunkSize, 0.0f);
+        stretcher.clear();
+
+        std::vector<const float*> inputs((size_t) numChannels);
+        for (int start = 0; start < numIn; start += chunkSize)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                inputs[(size_t) channel] = source.getReadPointer(channel, regionStart + start);
+            }
+            stretcher.putPlanarSamples(inputs.data(), (uint) juce::jmin(chunkSize, numIn - start));
+        }
+
+        std::fill(inputs.begin(), inputs.end(), silence.data());
+        while ((int) stretcher.numSamples() < numOut)
+        {
+            stretcher.putPlanarSamples(inputs.data(), (uint) chunkSize);
+        }
+
+        std::vector<float*> outputs((size_t) numChannels);
+        for (int done = 0; done < numOut;)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                outputs[(size_t) channel] = dest.getWritePointer(channel, destStart + done);
+            }
+            done += (int) stretcher.receivePlanarSamples(outputs.data(), (uint) (numOut - done));
+        }
+    }
+}
+
+TwoShotStretchCache::TwoShotStretchCache(TwoShotSynth& synth) :
+    juce::Thread("TwoShot stretch cache"),
+    m_synth(synth)
+{
+    startThread(3);
+}
+
+TwoShotStretchCache::~TwoShotStretchCache()
+{
+    stop();
+}
+
+void TwoShotStretchCache::stop()
+{
+    stopThread(4000);
+}
+
+void TwoShotStretchCache::setHostBpm(const double hostBpm) noexcept
+{
+    m_hostBpm.store(hostBpm, std::memory_order_relaxed);
+}
+
+void TwoShotStretchCache::run()
+{
+    while (! threadShouldExit())
+    {
+        // the audio thread can't wake this thread without taking a lock, so the tempo is polled
+        wait(50);
+
+        const double hostBpm = m_hostBpm.load(std::memory_order_relaxed);
+        TwoShotSoundSet::Ptr source = m_synth.getSoundSetToStretch();
+
+        if (source == nullptr || hostBpm <= 0)
+        {
+            continue;
+        }
+
+        const int bpmKey = juce::roundToInt(hostBpm * 100.0);
+        if (source == m_lastSource && bpmKey == m_lastBpmKey)
+        {
+            continue;
+        }
+        m_lastSource = source;
+        m_lastBpmKey = bpmKey;
+
+        // at the loop's own tempo the voices play the original sounds without stretching,
+        // and outside the stretcher's range they stretch them themselves
+        const double tempo = hostBpm / source->audioBpm;
+        if (! TwoShotStretcher::isStretch(tempo) || tempo < TwoShotStretcher::minTempo || tempo > TwoShotStretcher::maxTempo)
+        {
+            const juce::ScopedLock sl(m_synth.m_setLock);
+            if (m_synth.isCurrentSoundSet(*source))
+            {
+                m_synth.withdrawStretchedSoundSet();
+            }
+            continue;
+        }
+
+        // keyed on the tempo rather than the host BPM, as the same audio can be loaded at another BPM
+        const Key key { source->sounds.getFirst()->getAudioData()->hash, getLayout(*source), juce::roundToInt(tempo * 10000.0) };
+        const Entry* entry = m_entries.find(key);
+
+        if (entry == nullptr)
+        {
+            Entry newEntry { tempo, nullptr, {} };
+            if (! stretch(*source, newEntry))
+            {
+                // the sounds changed while they were being stretched, start again with the new ones
+                m_lastSource = nullptr;
+                continue;
+            }
+
+            entry = &m_entries.insert(key, std::move(newEntry));
+        }
+
+        const juce::ScopedLock sl(m_synth.m_setLock);
+        if (m_synth.isCurrentSoundSet(*source))
+        {
+            m_synth.publishStretchedSoundSet(createStretchedSet(*source, *entry));
+        }
+        else
+        {
+            m_lastSource = nullptr;
+        }
+    }
+}
+
+/**
+* Identifies how the source audio was cut into slices, as the same audio can be cut
+* into bars or at its transients, on different beat grids
+*/
+juce::uint64 TwoShotStretchCache::getLayout(const TwoShotSoundSet& source)
+{
+    juce::uint64 layout = 14695981039346656037ull;
+    for (auto* sound : source.sounds)
+    {
+        layout = (layout ^ (juce::uint64) sound->getRegionStart()) * 1099511628211ull;
+        layout = (layout ^ (juce::uint64) sound->getRegionLength()) * 1099511628211ull;
+    }
+    return layout;
+}
+
+/**
+* Stretches every slice of the source on its own, so none of them bleeds into the next,
+* and lays the results end to end in one buffer
+* @return false if the source stopped being the synth's current sounds, or the thread is stopping
+*/
+bool TwoShotStretchCache::stretch(const TwoShotSoundSet& source, Entry& entry)
+{
+    const auto* data = source.sounds.getFirst()->getAudioData();
+    const int numChannels = data->numChannels;
+
+    std::unique_ptr<soundtouch::TDStretch> stretcher(soundtouch::TDStretch::newInstance());
+    stretcher->setChannels(numChannels);
+    stretcher->setParameters(juce::jlimit(8000, 192000, juce::roundToInt(data->sampleRate)));
+    stretcher->setTempo(entry.tempo);
+
+    int numStretched = 0;
+    for (auto* sound : source.sounds)
+    {
+        const int length = juce::roundToInt(sound->getRegionLength() / entry.tempo);
+        entry.slices.add({ numStretched, numStretched + length });
+        numStretched += length;
+    }
+
+    juce::AudioBuffer<float> stretched(numChannels, juce::jmax(1, numStretched));
+    std::vector<float> silence;
+
+    for (int i = 0; i < source.sounds.size(); ++i)
+    {
+        if (threadShouldExit())
+        {
+            return false;
+        }
+
+        {
+            const juce::ScopedLock sl(m_synth.m_setLock);
+            if (! m_synth.isCurrentSoundSet(source))
+            {
+                return false;
+            }
+        }
+
+        const auto* sound = source.sounds.getObjectPointerUnchecked(i);
+        stretchRegion(*stretcher, *data, sound->getRegionStart(), sound->getRegionLength(),
+                      stretched, entry.slices[i].getStart(), entry.slices[i].getLength(), silence);
+    }
+
+    entry.audio = new TwoShotAudioData(std::move(stretched), data->sampleRate, numStretched);
+    return true;
+}
+
+/**
+* Builds sounds that play the stretched slices on the same notes as the source.
+* Must be called with the synth's set lock held
+*/
+TwoShotSoundSet* TwoShotStretchCache::createStretchedSet(TwoShotSoundSet& source, const Entry& entry) const
+{
+    auto* soundSet = new TwoShotSoundSet();
+    soundSet->audioSampleRate = source.audioSampleRate;
+    soundSet->audioBpm = source.audioBpm;
+    soundSet->isLoop = source.isLoop;
+    soundSet->beatOffset = source.beatOffset;
+    soundSet->stretchedFrom = &source;
+
+    for (int i = 0; i < source.sounds.size(); ++i)
+    {
+        soundSet->sounds.add(source.sounds.getObjectPointerUnchecked(i)->createStretchedCopy(
+            entry.audio,
+            entry.slices[i].getStart(),
+            entry.slices[i].getLength(),
+            entry.tempo));
+    }
+    return soundSet;
+}
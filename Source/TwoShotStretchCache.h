@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    TwoShotStretchCache.h
+    Created: 17 Oct 2026 6:40:03pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <tuple>
+#include "TwoShotSoundSet.h"
+#include "TwoShotLruCache.h"
+
+class TwoShotSynth;
+
+/**
+ * Time-stretches the LOOP MODE slices to the host tempo on a background thread, so the
+ * voices can play them back directly instead of running a stretcher each.
+ *
+ * The audio thread only reports the host BPM. When it changes, every slice of the current
+ * sounds is rendered through SoundTouch at the new tempo, and a set of stretched copies is
+ * handed to the synth, whose voices crossfade onto it. Recent results are kept in an LRU
+ * keyed by the source's hash, how it was sliced and how far it was stretched, so going back
+ * to a tempo is free. Reversed notes play the same copies backwards, so reversing costs nothing here.
+ *
+ * Only loops held in memory are stretched, see TwoShotAudioData::isStreamed().
+ */
+class TwoShotStretchCache : private juce::Thread
+{
+    public:
+        explicit TwoShotStretchCache(TwoShotSynth& synth);
+        ~TwoShotStretchCache() override;
+
+        /** Tells the cache the host tempo. Lock-free, called from the audio thread */
+        void setHostBpm(const double hostBpm) noexcept;
+
+        /** Stops the thread, abandoning any stretch in progress */
+        void stop();
+
+        /** The most stretched copies of whole sound sets kept at once */
+        static constexpr int maxNumEntries = 4;
+
+    private:
+        // the source's hash, how it was sliced, and how far it was stretched
+        using Key = std::tuple<juce::uint64, juce::uint64, int>;
+
+        struct Entry
+        {
+            double tempo;
+            TwoShotAudioData::Ptr audio;
+            juce::Array<juce::Range<int>> slices;
+        };
+
+        void run() override;
+        static juce::uint64 getLayout(const TwoShotSoundSet& source);
+        bool stretch(const TwoShotSoundSet& source, Entry& entry);
+        TwoShotSoundSet* createStretchedSet(TwoShotSoundSet& source, const Entry& entry) const;
+
+        TwoShotSynth& m_synth;
+        std::atomic<double> m_hostBpm { 0 };
+
+        TwoShotLruCache<Key, Entry> m_entries { maxNumEntries };
+
+        // what the synth was last given
+        TwoShotSoundSet::Ptr m_lastSource;
+        int m_lastBpmKey = 0;
+};
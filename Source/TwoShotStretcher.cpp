@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    TwoShotStretcher.cpp
+    Created: 17 Oct 2026 5:12:40pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotStretcher.h"
+
+TwoShotStretcher::TwoShotStretcher() :
+    m_stretch(soundtouch::TDStretch::newInstance()),
+    m_silence(blockSize, 0.0f)
+{
+    m_stretch->setChannels(2);
+}
+
+TwoShotStretcher::~TwoShotStretcher()
+{
+}
+
+void TwoShotStretcher::setSampleRate(double sampleRate)
+{
+    m_stretch->setParameters(jlimit(8000, 192000, roundToInt(sampleRate)));
+
+    // The buffers are given fixed rings, so neither ever allocates or moves its samples on the
+    // audio thread. Their sizes follow from how TDStretch works through its input:
+    // - it processes a frame (getLatency) whenever it has one, so between puts the input holds
+    //   less than a frame, and after a put less than a frame and a block
+    // - each frame adds a sequence (getOutputBatchSize) to the output and drops a skip
+    //   (getInputSampleReq, give or take a sample) from the input, and the first frame after a
+    //   reset skips less, so a put completes at most two frames and one per skip held past a frame
+    // - the voice only puts while it has less than a block of output ready
+    // The lengths follow the tempo, so the bounds are worked out at every step of tempoStep.
+    // Between steps they move by a few samples, well inside the block of margin each gets
+    constexpr double tempoStep = 1.0 / 1024.0;
+
+    uint maxFrame = 0;
+    for (double tempo = minTempo; tempo <= maxTempo; tempo += tempoStep)
+    {
+        m_stretch->setTempo(tempo);
+        maxFrame = jmax(maxFrame, (uint) m_stretch->getLatency());
+    }
+    const uint maxInput = maxFrame + blockSize;
+
+    uint maxOutput = 0;
+    for (double tempo = minTempo; tempo <= maxTempo; tempo += tempoStep)
+    {
+        m_stretch->setTempo(tempo);
+        const auto skip = (uint) jmax(1, m_stretch->getInputSampleReq() - 1);
+        const auto maxFrames = 2 + (maxInput - (uint) m_stretch->getLatency()) / skip;
+        maxOutput = jmax(maxOutput, blockSize + maxFrames * (uint) m_stretch->getOutputBatchSize());
+    }
+
+    // emptied first, so nothing is copied out of the old arena before it goes
+    m_stretch->clear();
+
+    using soundtouch::FIFOSampleBuffer;
+    const uint inputCapacity = maxInput + blockSize;
+    const uint outputCapacity = maxOutput + blockSize;
+    const auto inputSize = FIFOSampleBuffer::getArenaSize(inputCapacity, 2);
+    std::vector<float> arena(inputSize + FIFOSampleBuffer::getArenaSize(outputCapacity, 2), 0.0f);
+    getInputBuffer().useArena(arena.data(), inputCapacity);
+    getOutputBuffer().useArena(arena.data() + inputSize, outputCapacity);
+    m_arena.swap(arena);
+
+    m_stretch->setTempo(m_tempo);
+    m_stretch->clear();
+}
+
+void TwoShotStretcher::setTempo(double newTempo) noexcept
+{
+    newTempo = jlimit(minTempo, maxTempo, newTempo);
+
+    if (newTempo != m_tempo)
+    {
+        m_tempo = newTempo;
+        m_stretch->setTempo(m_tempo);
+    }
+}
+
+void TwoShotStretcher::reset() noexcept
+{
+    m_stretch->clear();
+}
+
+void TwoShotStretcher::putBlock(const float* left, const float* right, int numFrames) noexcept
+{
+    jassert(numFrames <= blockSize);
+
+    if (left == nullptr)
+    {
+        left = right = m_silence.data();
+    }
+
+    // interleaved straight into TDStretch's input
+    const float* channels[] = { left, right };
+    m_stretch->putPlanarSamples(channels, (uint) numFrames);
+
+    // the rings drop the oldest audio rather than overflow, which they never should
+    jassert(getNumDropped() == 0);
+}
+
+int TwoShotStretcher::getNumDropped() const noexcept
+{
+    return (int) (getInputBuffer().getNumDropped() + getOutputBuffer().getNumDropped());
+}
+
+soundtouch::FIFOSampleBuffer& TwoShotStretcher::getInputBuffer() const noexcept
+{
+    return *static_cast<soundtouch::FIFOSampleBuffer*>(m_stretch->getInput());
+}
+
+soundtouch::FIFOSampleBuffer& TwoShotStretcher::getOutputBuffer() const noexcept
+{
+    return *static_cast<soundtouch::FIFOSampleBuffer*>(m_stretch->getOutput());
+}
+
+int TwoShotStretcher::getNumFramesToCome() const noexcept
+{
+    return getNumReady() + roundToInt(m_stretch->getInput()->numSamples() / m_tempo);
+}
+
+int TwoShotStretcher::getNumReady() const noexcept
+{
+    return (int) m_stretch->numSamples();
+}
+
+void TwoShotStretcher::addTo(float* const* dest, int numChannels, const float* gains, int numFrames) noexcept
+{
+    jassert(numFrames <= blockSize);
+
+    // mixed straight out of TDStretch's output, then dropped from it
+    auto* output = m_stretch->getOutput();
+    numFrames = jmin(numFrames, (int) output->numSamples());
+    const float* frame = output->ptrBegin();
+
+    if (numChannels > 1)
+    {
+        for (int i = 0; i < numFrames; ++i)
+        {
+            dest[0][i] += frame[2 * i] * gains[i];
+            dest[1][i] += frame[2 * i + 1] * gains[i];
+        }
+    }
+    else
+    {
+        for (int i = 0; i < numFrames; ++i)
+        {
+            dest[0][i] += (frame[2 * i] + frame[2 * i + 1]) * 0.5f * gains[i];
+        }
+    }
+
+    m_stretch->receiveSamples((uint) numFrames);
+}
+
+int TwoShotStretcher::getLatency() const noexcept
+{
+    return m_stretch->getLatency();
+}
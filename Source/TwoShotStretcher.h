@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    TwoShotStretcher.h
+    Created: 17 Oct 2026 5:12:40pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <ea_soundtouch/ea_soundtouch.h>
+
+/**
+ * Changes the tempo of one voice's audio without changing its pitch, using SoundTouch's TDStretch.
+ *
+ * Audio goes in and comes out in blocks of at most blockSize frames. All the memory the
+ * stretcher can need, at any tempo between minTempo and maxTempo, is allocated by
+ * setSampleRate() as one arena holding fixed rings for TDStretch's input and output, so
+ * nothing on the audio thread allocates or shuffles samples along.
+ */
+class TwoShotStretcher
+{
+    public:
+        TwoShotStretcher();
+        ~TwoShotStretcher();
+
+        /** Sets the rate the audio is stretched at and allocates for it. Must not be called from the audio thread. */
+        void setSampleRate(double sampleRate);
+
+        /** Sets the playback speed, where 2 is twice as fast. Clamped to [minTempo, maxTempo] */
+        void setTempo(double newTempo) noexcept;
+
+        /** Drops any audio still in the stretcher, ready for a new note */
+        void reset() noexcept;
+
+        /** Adds a block of stereo audio. Silence is added if left and right are nullptr. */
+        void putBlock(const float* left, const float* right, int numFrames) noexcept;
+
+        /**
+         * Returns roughly how many frames of output the audio added so far will make,
+         * counting those already ready. Once the input has run out, this tells the voice
+         * how much more to play while silence pushes the rest through.
+         */
+        int getNumFramesToCome() const noexcept;
+
+        /** Returns the number of stretched frames ready to be taken */
+        int getNumReady() const noexcept;
+
+        /** Takes frames out of the stretcher and adds them to dest, scaled by gains */
+        void addTo(float* const* dest, int numChannels, const float* gains, int numFrames) noexcept;
+
+        /** The input needed before the first frame comes out */
+        int getLatency() const noexcept;
+
+        /** Returns how much audio the fixed buffers have had to drop for want of room, which should be none */
+        int getNumDropped() const noexcept;
+
+        /** Returns false for tempos close enough to 1 that audio can be played as it is */
+        static bool isStretch(double tempo) noexcept { return std::abs(tempo - 1.0) > tempoTolerance; }
+
+        static constexpr int blockSize = 256;
+        static constexpr double minTempo = 0.25;
+        static constexpr double maxTempo = 4.0;
+
+        /** A tenth of a millisecond per second, well under what anyone can hear drift */
+        static constexpr double tempoTolerance = 1.0e-4;
+
+    private:
+        soundtouch::FIFOSampleBuffer& getInputBuffer() const noexcept;
+        soundtouch::FIFOSampleBuffer& getOutputBuffer() const noexcept;
+
+        std::unique_ptr<soundtouch::TDStretch> m_stretch;
+        std::vector<float> m_silence;
+        // backs the rings of m_stretch's input and output buffers
+        std::vector<float> m_arena;
+        double m_tempo = 1.0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TwoShotStretcher)
+};
@@ -24,29 +24,50 @@
 */
 
 TwoShotSynth::TwoShotSynth() : 
+    m_diskThread("TwoShot disk streaming"),
     m_audioSampleRate(44100),
     m_audioBPM(120),
     m_isReversed(false),
     m_isLoop(true),
     m_midiNaturalNote(64)
 {
-    m_soundTouch.setChannels(2);
-    m_soundTouch.setSampleRate(m_audioSampleRate);
-    m_soundTouch.setRate(1.0);
-    m_soundTouch.setPitch(0.5);
-    m_soundTouch.flush();
+    m_diskThread.startThread(5);
 
-    int numVoices = 16;
+    setPolyphony(defaultPolyphony);
+}
 
-    for (auto i = 0; i < numVoices; ++i)
+TwoShotSynth::~TwoShotSynth()
+{
+    m_loader.stop();
+    m_slicer.stop();
+    m_stretchCache.stop();
+    m_resampleCache.stop();
+    m_synth.allNotesOff(0, false);
+
+    if (auto* pendingSet = m_pendingSet.exchange(nullptr))
     {
-        m_synth.addVoice(new TwoShotVoice());
+        pendingSet->decReferenceCount();
+    }
+    if (m_liveSet != nullptr)
+    {
+        m_liveSet->decReferenceCount();
     }
 }
 
-TwoShotSynth::~TwoShotSynth()
+/**
+* Loads an audio file on the loader thread, then updates the audio for the TwoShotSynth
+*/
+void TwoShotSynth::loadAudioFile(const juce::File& file, std::optional<const double> audioBpm)
 {
+    m_loader.loadAudioFile(file, audioBpm);
+}
 
+/**
+* Loads a loop on the loader thread, at the tempo and on the beat grid detected from it
+*/
+void TwoShotSynth::loadLoopFile(const juce::File& file)
+{
+    m_loader.loadLoopFile(file);
 }
 
 /**
@@ -60,108 +81,405 @@ void TwoShotSynth::setAudio(
     const size_t sampleProgress
 )
 {
-    m_synth.clearSounds();
+    setAudio(
+        new TwoShotAudioData(std::move(buffer), audioSampleRate, (int) (maxSampleLengthSeconds * audioSampleRate)),
+        audioBpm
+    );
+}
+
+/**
+* Updates the audio for the TwoShotSynth from audio that is already decoded, or is streamed from disk
+*/
+void TwoShotSynth::setAudio(TwoShotAudioData::Ptr audioData, std::optional<const double> audioBpm, const int beatOffset)
+{
+    juce::Array<int> onsets;
+    if (audioBpm.has_value() && m_slicing == TwoShotSlicer::Slicing::transients && ! audioData->isStreamed())
+    {
+        if (m_slicer.findOnsets(audioData->hash, onsets))
+        {
+            publishSoundSet(createSoundSet(audioData, audioBpm, beatOffset, &onsets));
+            return;
+        }
+
+        // cut into bars for now, and again once the slicer has found the transients
+        m_slicer.analyse(audioData);
+    }
+    publishSoundSet(createSoundSet(audioData, audioBpm, beatOffset));
+}
+
+TwoShotSoundSet* TwoShotSynth::createSoundSet(
+    TwoShotAudioData::Ptr audioData,
+    std::optional<const double> audioBpm,
+    const int beatOffset,
+    const juce::Array<int>* onsets
+)
+{
+    const double audioSampleRate = audioData->sampleRate;
+    auto* soundSet = new TwoShotSoundSet();
+    soundSet->audioSampleRate = audioSampleRate;
+
+    // every sound below plays a region of the same audio, nothing is copied per slice
     if (audioBpm.has_value())
     {
-        m_audioBPM = audioBpm.value();
-        m_isLoop = true;
-        setIsLoop(true);
+        soundSet->audioBpm = audioBpm.value();
+        soundSet->isLoop = true;
         double beatsPerSecond = (audioBpm.value() / 60.0);
         double beatsPerSample = beatsPerSecond / audioSampleRate;
         double samplesPerBeat = 1.0 / beatsPerSample;
         int samplesPerBar = (int) samplesPerBeat * 4.0;
         int fadeLength = 70;
-        m_audioSampleRate = audioSampleRate;
-        int startSample = 0;
-        int numSamples = jmin((int) samplesPerBar, (int) buffer.getNumSamples());
-        int i = 0;
-        while (numSamples >= fadeLength && startSample < buffer.getNumSamples())
+        soundSet->beatOffset = beatOffset;
+
+        const auto sliceStarts = getSliceStarts(audioData->numSamples, samplesPerBar, beatOffset, fadeLength, onsets);
+        for (int i = 0; i < sliceStarts.size() && i < maxNumSounds; ++i)
         {
+            const int startSample = sliceStarts.getUnchecked(i);
+            const int endSample = i + 1 < sliceStarts.size() ? sliceStarts.getUnchecked(i + 1) : audioData->numSamples;
+            const int numSamples = endSample - startSample;
+            if (numSamples < fadeLength)
+            {
+                break;
+            }
+
             BigInteger range;
             range.setBit(m_midiNaturalNote + i);
-            m_synth.addSound(new TwoShotSound(
-                buffer,
-                audioSampleRate,
+            soundSet->sounds.add(new TwoShotSound(
+                audioData,
                 range, 
                 m_midiNaturalNote + i, 
                 startSample, 
                 numSamples, 
-                fadeLength, 
-                0.01, 
-                0.01, 
-                120
+                fadeLength
             ));
-            startSample += samplesPerBar;
-            numSamples = jmin((int)samplesPerBar, (int)buffer.getNumSamples() - startSample);
-            i++;
         }
     }
     else
     {
-        m_isLoop = false;
-        setIsLoop(false);
+        soundSet->isLoop = false;
         BigInteger range;
         range.setRange(0, 127, true);
-        m_audioSampleRate = audioSampleRate;
-        m_synth.addSound(new TwoShotSound(buffer, audioSampleRate, range, m_midiNaturalNote, 0.01, 0.01, 120));
+        soundSet->sounds.add(new TwoShotSound(audioData, range, m_midiNaturalNote));
+    }
+    return soundSet;
+}
+
+/**
+* Returns where each slice of a loop starts: every bar of the beat grid, or at each onset moved to
+* the nearest step of the grid. Each slice runs on to the start of the next, and any audio before
+* the grid starts is a slice of its own, if it's long enough
+*/
+juce::Array<int> TwoShotSynth::getSliceStarts(
+    const int numSamples,
+    const double samplesPerBar,
+    const int beatOffset,
+    const int minSliceLength,
+    const juce::Array<int>* onsets
+) const
+{
+    juce::Array<int> starts;
+    starts.add(0);
+
+    auto addStart = [&](int start)
+    {
+        if (start >= starts.getLast() + minSliceLength && start < numSamples)
+        {
+            starts.add(start);
+        }
+    };
+
+    if (onsets == nullptr)
+    {
+        for (double start = beatOffset; start < numSamples; start += samplesPerBar)
+        {
+            addStart((int) start);
+        }
+        return starts;
     }
-    if (m_isReversed)
+
+    const double gridStep = samplesPerBar / gridStepsPerBar;
+    for (const int onset : *onsets)
     {
-        m_isReversed = false;
-        setReverse(true);
+        addStart((int) (beatOffset + juce::roundToInt((onset - beatOffset) / gridStep) * gridStep));
     }
+    return starts;
 }
 
 /**
-* This is called when the host updates it's sampleRate
+* Called on the slicer thread with the onsets it found, cuts the audio at them if it is still what's playing
 */
-void TwoShotSynth::setHostSampleRate(const double currentSampleRate)
+void TwoShotSynth::sliceAtOnsets(const TwoShotAudioData& audioData, const juce::Array<int>& onsets)
 {
-    m_synth.setCurrentPlaybackSampleRate(currentSampleRate);
+    const ScopedLock sl(m_setLock);
+    if (m_slicing != TwoShotSlicer::Slicing::transients
+        || m_currentSet == nullptr
+        || ! m_currentSet->isLoop
+        || m_currentSet->sounds.isEmpty())
+    {
+        return;
+    }
+
+    // the onsets were found in the original audio, not a copy converted to the host rate
+    const auto& source = m_currentSet->getSourceSet();
+    if (source.sounds.getFirst()->getAudioData() != &audioData)
+    {
+        return;
+    }
+
+    replaceCurrentSoundSet(createSoundSet(
+        source.sounds.getFirst()->getAudioData(),
+        source.audioBpm,
+        source.beatOffset,
+        &onsets
+    ));
 }
 
 /**
-* This is called when the user clicks the reverse toggle in the UI
+* Cuts the audio that is playing again, the way the slicing says
 */
-void TwoShotSynth::setReverse(const bool isReversed)
+void TwoShotSynth::setSlicing(const TwoShotSlicer::Slicing slicing)
 {
-    if (m_isReversed != isReversed)
+    if (m_slicing.exchange(slicing) == slicing)
     {
-        reverse();
-        m_isReversed = isReversed;
+        return;
     }
+
+    const ScopedLock sl(m_setLock);
+    if (m_currentSet == nullptr || ! m_currentSet->isLoop || m_currentSet->sounds.isEmpty())
+    {
+        return;
+    }
+
+    // recut from the original audio, which the resample cache converts again
+    TwoShotSoundSet::Ptr source = &m_currentSet->getSourceSet();
+    TwoShotAudioData::Ptr audioData = source->sounds.getFirst()->getAudioData();
+
+    // streamed audio is only ever cut into bars, and recutting it would read the file here
+    // through the reader the disk thread is streaming from
+    if (audioData->isStreamed())
+    {
+        return;
+    }
+
+    if (slicing == TwoShotSlicer::Slicing::bars)
+    {
+        replaceCurrentSoundSet(createSoundSet(audioData, source->audioBpm, source->beatOffset));
+    }
+    else
+    {
+        juce::Array<int> onsets;
+        if (m_slicer.findOnsets(audioData->hash, onsets))
+        {
+            replaceCurrentSoundSet(createSoundSet(audioData, source->audioBpm, source->beatOffset, &onsets));
+        }
+        else
+        {
+            m_slicer.analyse(audioData);
+        }
+    }
+}
+
+/**
+* Swaps in a set cut from the audio that is already playing. Must be called with m_setLock held
+*/
+void TwoShotSynth::replaceCurrentSoundSet(TwoShotSoundSet* soundSet)
+{
+    m_currentSet = soundSet;
+    m_stretchedSet = nullptr;
+    handOverSoundSet(soundSet);
 }
 
-void TwoShotSynth::reverse()
+void TwoShotSynth::publishSoundSet(TwoShotSoundSet* soundSet)
 {
-    if (m_isLoop)
     {
-        for (int i = 0; i < m_synth.getNumSounds(); ++i)
-        {
-            const int numSamples = getSamplerAudio(i)->getNumSamples();
+        const ScopedLock sl(m_setLock);
+        m_currentSet = soundSet;
+        m_stretchedSet = nullptr;
+    }
+
+    handOverSoundSet(soundSet);
+    m_resampleCache.soundsChanged();
+}
+
+/**
+* Hands a set to the audio thread, which installs it at the start of its next block
+*/
+void TwoShotSynth::handOverSoundSet(TwoShotSoundSet* soundSet)
+{
+    // the reference we hand over travels with the pointer, and is dropped by the
+    // release pool once the audio thread is done with the set
+    soundSet->incReferenceCount();
 
-            getSamplerAudio(i)->reverse(0, numSamples);
-            auto sound = dynamic_cast<TwoShotSound*>(m_synth.getSound(i).get());
-            if (sound)
+    // a set that was superseded before the audio thread picked it up was never
+    // played, so it can go straight away
+    if (auto* supersededSet = m_pendingSet.exchange(soundSet))
+    {
+        supersededSet->decReferenceCount();
+    }
+}
+
+/**
+* Called at the start of every audio block, swaps in the most recently published set
+*/
+void TwoShotSynth::installPendingSoundSet()
+{
+    if (m_pendingSet.load(std::memory_order_relaxed) == nullptr || ! m_releasePool.canRetire())
+    {
+        return;
+    }
+
+    auto* soundSet = m_pendingSet.exchange(nullptr);
+
+    if (soundSet == nullptr)
+    {
+        return;
+    }
+
+    m_synth.installSounds(*soundSet);
+    m_audioSampleRate = soundSet->audioSampleRate;
+    m_audioBPM = soundSet->audioBpm;
+    m_isLoop = soundSet->isLoop;
+    ++m_parameterChanges;
+
+    // voices move onto stretched copies, and back off them when the originals return
+    if (soundSet->stretchedFrom != nullptr || (m_liveSet != nullptr && m_liveSet->stretchedFrom.get() == soundSet))
+    {
+        crossfadeVoicesTo(*soundSet);
+    }
+
+    if (m_liveSet != nullptr)
+    {
+        m_releasePool.retire(m_liveSet);
+    }
+    m_liveSet = soundSet;
+}
+
+/**
+* Moves every voice that is playing one of the original sounds, or a stretched copy,
+* onto the matching sound of a newly installed set. Called on the audio thread.
+*/
+void TwoShotSynth::crossfadeVoicesTo(const TwoShotSoundSet& soundSet)
+{
+    m_synth.forEachPlayingVoice([&soundSet](TwoShotVoice& voice)
+    {
+        const TwoShotSound* original = voice.getOriginalSound();
+
+        for (auto* sound : soundSet.sounds)
+        {
+            if (sound->getOriginal() == original)
             {
-                BigInteger midiNotes;
-                int midiIndex = (m_synth.getNumSounds() + m_midiNaturalNote - 1) - i;
-                DBG(midiIndex);
-                if (m_isReversed)
-                {
-                    midiIndex = m_midiNaturalNote + i;
-                }
-                midiNotes.setBit(midiIndex);
-                sound->setMidiNotes(midiNotes, midiIndex);
+                voice.crossfadeTo(sound);
+                break;
             }
         }
+    });
+}
+
+/**
+* Returns the set the stretch cache should work on: the current sounds, if they are
+* a loop held in memory
+*/
+TwoShotSoundSet::Ptr TwoShotSynth::getSoundSetToStretch()
+{
+    const ScopedLock sl(m_setLock);
+
+    if (m_currentSet == nullptr
+        || ! m_currentSet->isLoop
+        || m_currentSet->sounds.isEmpty()
+        || m_currentSet->sounds.getFirst()->getAudioData()->isStreamed())
+    {
+        return nullptr;
     }
-    else
+    return m_currentSet;
+}
+
+/**
+* Returns the set the resample cache should convert: the current sounds, if they are held in memory
+*/
+TwoShotSoundSet::Ptr TwoShotSynth::getSoundSetToConvert()
+{
+    const ScopedLock sl(m_setLock);
+
+    if (m_currentSet == nullptr
+        || m_currentSet->sounds.isEmpty()
+        || m_currentSet->sounds.getFirst()->getAudioData()->isStreamed())
+    {
+        return nullptr;
+    }
+    return m_currentSet;
+}
+
+/**
+* Returns true if stretching or converting this set is still worth finishing. Must be called with m_setLock held
+*/
+bool TwoShotSynth::isCurrentSoundSet(const TwoShotSoundSet& soundSet) const
+{
+    return m_currentSet.get() == &soundSet;
+}
+
+/**
+* Hands over stretched copies of the current sounds. Must be called with m_setLock held,
+* after checking isCurrentSoundSet()
+*/
+void TwoShotSynth::publishStretchedSoundSet(TwoShotSoundSet* stretchedSet)
+{
+    m_stretchedSet = stretchedSet;
+    handOverSoundSet(stretchedSet);
+}
+
+/**
+* Hands the current sounds back in place of their stretched copies, once the host tempo no
+* longer needs the copies. Must be called with m_setLock held
+*/
+void TwoShotSynth::withdrawStretchedSoundSet()
+{
+    if (m_stretchedSet == nullptr)
     {
-        const int soundIndex = m_synth.getNumSounds() - 1;
-        const int numSamples = getSamplerAudio(soundIndex)->getNumSamples();
-        getSamplerAudio(soundIndex)->reverse(soundIndex, numSamples);
+        return;
     }
+
+    m_stretchedSet = nullptr;
+    handOverSoundSet(m_currentSet.get());
+}
+
+/**
+* Sounds longer than diskStreamingThresholdSeconds are streamed from disk while this is on
+*/
+void TwoShotSynth::setDiskStreaming(const bool shouldStream)
+{
+    m_diskStreaming = shouldStream;
+}
+
+bool TwoShotSynth::shouldStreamFromDisk(const double lengthSeconds) const
+{
+    return m_diskStreaming && lengthSeconds > diskStreamingThresholdSeconds;
+}
+
+/**
+* This is called when the host updates it's sampleRate
+*/
+void TwoShotSynth::setHostSampleRate(const double currentSampleRate)
+{
+    m_synth.setCurrentPlaybackSampleRate(currentSampleRate);
+    m_resampleCache.setHostSampleRate(currentSampleRate);
+}
+
+/**
+* Sounds at another rate from the host's play from a copy converted to it while this is on
+*/
+void TwoShotSynth::setSampleRateConversion(const bool shouldConvert)
+{
+    m_resampleCache.setEnabled(shouldConvert);
+}
+
+/**
+* This is called when the user clicks the reverse toggle in the UI. Only a flag changes here:
+* the audio thread picks it up at the start of its next block, and the voices read the
+* same audio backwards
+*/
+void TwoShotSynth::setReverse(const bool isReversed)
+{
+    m_isReversed = isReversed;
+    ++m_parameterChanges;
 }
 
 /**
@@ -169,8 +487,8 @@ void TwoShotSynth::reverse()
 */
 void TwoShotSynth::setAttack(const double attackSeconds)
 {
-    m_adsrParams.attack = static_cast<float>(attackSeconds);
-    updateADSR();
+    m_attack = static_cast<float>(attackSeconds);
+    ++m_parameterChanges;
 }
 
 /**
@@ -178,8 +496,8 @@ void TwoShotSynth::setAttack(const double attackSeconds)
 */
 void TwoShotSynth::setDecay(const double decaySeconds)
 {
-    m_adsrParams.release = static_cast<float>(decaySeconds);
-    updateADSR();
+    m_release = static_cast<float>(decaySeconds);
+    ++m_parameterChanges;
 }
 
 /**
@@ -187,27 +505,76 @@ void TwoShotSynth::setDecay(const double decaySeconds)
 */
 void TwoShotSynth::setDetune(const double detuneAmount)
 {
-    for (int i = 0; i < m_synth.getNumVoices(); ++i)
+    m_detuneRatio = std::pow(2.0, detuneAmount / 1200.0);
+    ++m_parameterChanges;
+}
+
+/**
+* Changes how every voice resamples, trading CPU for less aliasing when repitching
+*/
+void TwoShotSynth::setInterpolation(const TwoShotRenderKernels::Interpolation interpolation)
+{
+    m_interpolation = interpolation;
+    ++m_parameterChanges;
+}
+
+/**
+* Adds voices until there are enough for numVoices notes, then limits the notes to that
+*/
+void TwoShotSynth::setPolyphony(const int numVoices)
+{
+    const int polyphony = jlimit(1, TwoShotVoiceAllocator::maxNumVoices, numVoices);
+
+    while (m_synth.getNumVoices() < polyphony)
     {
-        if (auto voice = dynamic_cast<TwoShotVoice*>(m_synth.getVoice(i)))
-        {
-            voice->setDetune(detuneAmount);
-        }
+        m_synth.addVoice(new TwoShotVoice(m_diskThread, m_voiceParameters));
     }
+    m_synth.setPolyphony(polyphony);
+}
+
+void TwoShotSynth::setVoiceStealing(const TwoShotVoiceAllocator::Stealing stealing)
+{
+    m_synth.setVoiceStealing(stealing);
+}
+
+void TwoShotSynth::setRenderThreads(const int numThreads)
+{
+    m_synth.setRenderThreads(numThreads);
 }
 
 /**
-* This is called when user switches to mode 2
+* Rebuilds the parameters the voices share, if a setting or the host tempo has changed
+* since the last block. Called on the audio thread, before the voices render.
 */
-void TwoShotSynth::setIsLoop(const bool isLoop)
+void TwoShotSynth::updateVoiceParameters(std::optional<const double> currentHostBpm)
 {
-    for (int i = 0; i < m_synth.getNumVoices(); ++i)
+    const auto parameterChanges = m_parameterChanges.load();
+    const bool hostBpmChanged = currentHostBpm.has_value() && currentHostBpm.value() != m_hostBpm;
+
+    if (parameterChanges == m_appliedParameterChanges && ! hostBpmChanged)
     {
-        if (auto voice = dynamic_cast<TwoShotVoice*>(m_synth.getVoice(i)))
-        {
-            voice->setIsLoop(isLoop);
-        }
+        return;
     }
+    m_appliedParameterChanges = parameterChanges;
+
+    if (hostBpmChanged)
+    {
+        m_hostBpm = currentHostBpm.value();
+        m_stretchCache.setHostBpm(m_hostBpm);
+    }
+
+    // without a tempo from the host, loops keep playing at the last one it reported
+    if (m_hostBpm > 0)
+    {
+        m_voiceParameters.bpmCompRatio = m_hostBpm / m_audioBPM;
+    }
+    m_voiceParameters.detuneRatio = m_detuneRatio;
+    m_voiceParameters.isLoop = m_isLoop;
+    m_voiceParameters.isReversed = m_isReversed;
+    m_synth.setReversed(m_isReversed);
+    m_voiceParameters.envelope.attack = m_attack;
+    m_voiceParameters.envelope.release = m_release;
+    m_voiceParameters.interpolation = m_interpolation;
 }
 
 /**
@@ -219,63 +586,197 @@ void TwoShotSynth::processNextBlock(
     std::optional<const double> currentHostBpm
 )
 {
-    if (currentHostBpm.has_value())
+    installPendingSoundSet();
+    updateVoiceParameters(currentHostBpm);
+
+    m_synth.renderBlock(outputAudio, midiData, 0, outputAudio.getNumSamples());
+}
+
+
+TwoShotSynth::Engine::Engine()
+{
+    // installSounds() must never grow the array on the audio thread
+    sounds.ensureStorageAllocated(maxNumSounds);
+    voices.ensureStorageAllocated(TwoShotVoiceAllocator::maxNumVoices);
+}
+
+TwoShotVoice* TwoShotSynth::Engine::addVoice(TwoShotVoice* voice)
+{
+    // takes the lock itself, and sets the voice's sample rate
+    juce::Synthesiser::addVoice(voice);
+
+    const ScopedLock sl(lock);
+    m_allocator.addVoice(voice);
+    return voice;
+}
+
+void TwoShotSynth::Engine::setPolyphony(int numVoices)
+{
+    const ScopedLock sl(lock);
+    m_allocator.setPolyphony(numVoices);
+}
+
+void TwoShotSynth::Engine::setVoiceStealing(TwoShotVoiceAllocator::Stealing stealing)
+{
+    const ScopedLock sl(lock);
+    m_allocator.setStealing(stealing);
+}
+
+/**
+* Starts the new workers before taking the lock, and stops the old ones after letting it go,
+* so the audio thread is only held up for the swap
+*/
+void TwoShotSynth::Engine::setRenderThreads(int numThreads)
+{
+    std::unique_ptr<TwoShotRenderWorkers> workers;
+    if (numThreads > 0)
     {
-        //m_soundTouch.setPitch(m_audioBPM / currentHostBpm.value());
-        for (int i = 0; i < m_synth.getNumVoices(); ++i)
+        workers = std::make_unique<TwoShotRenderWorkers>(numThreads);
+    }
+
+    const ScopedLock sl(lock);
+    std::swap(workers, m_workers);
+}
+
+/**
+* Starts the note's sound on a voice from the allocator. Unlike juce::Synthesiser, neither
+* the sounds nor the voices are searched, and only one sound plays per note.
+*/
+void TwoShotSynth::Engine::noteOn(int midiChannel, int midiNoteNumber, float velocity)
+{
+    const ScopedLock sl(lock);
+
+    if (! isPositiveAndBelow(midiNoteNumber, (int) m_soundForNote->size()))
+    {
+        return;
+    }
+
+    auto* sound = (*m_soundForNote)[(size_t) midiNoteNumber];
+    if (sound == nullptr || ! sound->appliesToChannel(midiChannel))
+    {
+        return;
+    }
+
+    // if the note is still ringing, it's let go first
+    if (auto* ringingVoice = m_allocator.findVoicePlaying(midiNoteNumber, midiChannel))
+    {
+        stopVoice(ringingVoice, 1.0f, true);
+    }
+
+    if (auto* voice = m_allocator.allocate(midiNoteNumber, isNoteStealingEnabled()))
+    {
+        startVoice(voice, sound, midiChannel, midiNoteNumber, velocity);
+    }
+}
+
+void TwoShotSynth::Engine::noteOff(int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff)
+{
+    const ScopedLock sl(lock);
+
+    if (auto* voice = m_allocator.findVoicePlaying(midiNoteNumber, midiChannel))
+    {
+        // held by a pedal, the voice is stopped when the pedal comes up
+        voice->setKeyDown(false);
+        if (! (voice->isSustainPedalDown() || voice->isSostenutoPedalDown()))
         {
-            if (auto voice = dynamic_cast<TwoShotVoice*>(m_synth.getVoice(i)))
-            {
-                voice->setBPMComp(m_audioBPM, currentHostBpm.value());
-            }
+            stopVoice(voice, velocity, allowTailOff);
         }
     }
-    m_synth.renderNextBlock(outputAudio, midiData, 0, outputAudio.getNumSamples());
-    //int nch = 2;
-    //// copy input samples in interleaved format to helper buffer
-    //for (int i = 0; i < nch; ++i)
-    //    for (int j = 0; j < outputAudio.getNumSamples(); ++j)
-    //        m_buf[j * nch + i] = outputAudio.getSample(i, j);
-    //m_soundTouch.putSamples(m_buf.data(), outputAudio.getNumSamples());
-    //if (m_soundTouch.numSamples() >= outputAudio.getNumSamples()) // does SoundTouch have enough samples ready?
-    //{
-    //    m_soundTouch.receiveSamples(m_buf.data(), outputAudio.getNumSamples());
-    //    // copy SoundTouch output samples to split format Juce buffer
-    //    for (int i = 0; i < nch; ++i)
-    //        for (int j = 0; j < outputAudio.getNumSamples(); ++j)
-    //            outputAudio.setSample(i, j, m_buf[j * nch + i]);
-    //}
-    //else
-    //{
-    //    // SoundTouch didn't have enough output samples, just output silence
-    //    outputAudio.clear();
-    //}
 }
 
-
-AudioBuffer<float>* TwoShotSynth::getSamplerAudio(int soundIndex)
+void TwoShotSynth::Engine::renderBlock(AudioBuffer<float>& outputAudio, const MidiBuffer& midiData, int startSample, int numSamples)
 {
-    // get the last added synth sound as a TwoShotSound*
-    auto sound = dynamic_cast<TwoShotSound*>(m_synth.getSound(soundIndex).get());
+    // the voices' pitch depends on the rate, so nothing can be played without one
+    if (getSampleRate() == 0.0)
+    {
+        jassertfalse;
+        return;
+    }
+
+    const ScopedLock sl(lock);
+    const int endSample = startSample + numSamples;
+    int position = startSample;
+
+    for (const auto metadata : midiData)
+    {
+        // events outside the block are handled at its nearest end, as juce::Synthesiser does
+        const int eventPosition = jlimit(position, endSample, metadata.samplePosition);
+
+        if (eventPosition > position)
+        {
+            renderVoices(outputAudio, position, eventPosition - position);
+            position = eventPosition;
+        }
+        handleMidiEvent(metadata.getMessage());
+    }
+
+    if (endSample > position)
+    {
+        renderVoices(outputAudio, position, endSample - position);
+    }
+}
 
-    if (sound)
+/**
+* Renders only the voices that are playing, rather than asking every voice, sharing them
+* out between the workers when there are enough
+*/
+void TwoShotSynth::Engine::renderVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    if (m_workers == nullptr || ! TwoShotRenderWorkers::isWorthSharing(m_allocator.getNumPlaying(), numSamples))
     {
-        return sound->getAudioData();
+        m_allocator.renderVoices(outputAudio, startSample, numSamples);
+        return;
     }
 
-    // just in case it somehow happens that the sound doesn't exist or isn't a SamplerSound,
-    // return a static instance of an empty AudioBuffer here...
-    static AudioBuffer<float> dummybuffer;
-    return &dummybuffer;
+    int numVoices = 0;
+    m_allocator.forEachPlayingVoice([this, &numVoices](TwoShotVoice& voice)
+    {
+        m_playingVoices[(size_t) numVoices++] = &voice;
+    });
+
+    m_workers->renderVoices(m_playingVoices.data(), numVoices, outputAudio, startSample, numSamples);
+    m_allocator.freeFinishedVoices();
 }
 
-void TwoShotSynth::updateADSR()
+/**
+* Replaces the playable sounds with those of the given set. Called on the audio thread:
+* clearQuick() keeps the storage, and the outgoing sounds are still referenced by their
+* own set, so nothing is allocated or freed here.
+*
+* Both note maps are built at once. Reversed, the slices of a loop are given to the notes
+* in the order they play backwards, so the last slice is on the first note; a sample plays
+* on the same notes either way.
+*/
+void TwoShotSynth::Engine::installSounds(const TwoShotSoundSet& soundSet)
 {
-    for (int i = 0; i < m_synth.getNumSounds(); ++i)
+    jassert(soundSet.sounds.size() <= maxNumSounds);
+    const ScopedLock sl(lock);
+    sounds.clearQuick();
+    m_noteMaps[0].fill(nullptr);
+    m_noteMaps[1].fill(nullptr);
+
+    const int numSounds = soundSet.sounds.size();
+    for (int i = 0; i < numSounds; ++i)
     {
-        if (auto sound = dynamic_cast<TwoShotSound*>(m_synth.getSound(i).get()))
+        auto* sound = soundSet.sounds.getObjectPointerUnchecked(i);
+        auto* reversedSound = soundSet.isLoop ? soundSet.sounds.getObjectPointerUnchecked(numSounds - 1 - i) : sound;
+        sounds.add(sound);
+
+        // the first sound on a note wins, the sets never put two on one
+        const auto& notes = sound->getMidiNotes();
+        for (int note = notes.findNextSetBit(0); isPositiveAndBelow(note, (int) m_noteMaps[0].size()); note = notes.findNextSetBit(note + 1))
         {
-            sound->setEnvelopeParameters(m_adsrParams);
+            if (m_noteMaps[0][(size_t) note] == nullptr)
+            {
+                m_noteMaps[0][(size_t) note] = sound;
+                m_noteMaps[1][(size_t) note] = reversedSound;
+            }
         }
     }
-}
\ No newline at end of file
+}
+
+void TwoShotSynth::Engine::setReversed(bool isReversed) noexcept
+{
+    const ScopedLock sl(lock);
+    m_soundForNote = &m_noteMaps[isReversed ? 1 : 0];
+}
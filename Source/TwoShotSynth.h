@@ -13,6 +13,15 @@
 #include <JuceHeader.h>
 #include "TwoShotSound.h"
 #include "TwoShotVoice.h"
+#include "TwoShotVoiceParameters.h"
+#include "TwoShotVoiceAllocator.h"
+#include "TwoShotRenderWorkers.h"
+#include "TwoShotSoundSet.h"
+#include "TwoShotReleasePool.h"
+#include "TwoShotLoader.h"
+#include "TwoShotStretchCache.h"
+#include "TwoShotResampleCache.h"
+#include "TwoShotSlicer.h"
 
 /**
  * Has 2 modes:
@@ -31,8 +40,22 @@ class TwoShotSynth
         TwoShotSynth();
         ~TwoShotSynth();
 
+        /**
+         * Loads an audio file on the loader thread, then updates the audio for the Synth
+         * @param audioBpm if this value is present, then this is a polyphonic Loop, and the Synth goes into LOOP MODE
+         */
+        void loadAudioFile(const juce::File& file, std::optional<const double> audioBpm);
+
+        /**
+         * Loads a loop whose tempo isn't known on the loader thread, in LOOP MODE at the tempo
+         * detected from it, sliced on its beat grid. If no tempo is found, it is loaded as a sample
+         */
+        void loadLoopFile(const juce::File& file);
+
         /**
          * Updates the audio for the Synth
+         * The sounds are built on the calling thread and picked up by the audio thread
+         * at the start of its next block, so this must never be called from the audio thread.
          * @param audioBpm if this value is present, then this is a polyphonic Loop, and the Synth goes into LOOP MODE
          */
         void setAudio(
@@ -42,15 +65,43 @@ class TwoShotSynth
             const size_t sampleProgress = 0
         );
 
+        /**
+         * Updates the audio for the Synth from audio that is already decoded, or is streamed from disk
+         * @param audioBpm if this value is present, then this is a polyphonic Loop, and the Synth goes into LOOP MODE
+         * @param beatOffset where the loop's beat grid starts, in samples
+         */
+        void setAudio(TwoShotAudioData::Ptr audioData, std::optional<const double> audioBpm, const int beatOffset = 0);
+
+        /**
+         * Turns disk streaming on or off for sounds loaded from now on.
+         * Streamed sounds only keep their first TwoShotSound::streamHeadSeconds in memory
+         */
+        void setDiskStreaming(const bool shouldStream);
+
+        /**
+         * Returns true if audio of this length should be streamed from disk rather than decoded into memory
+         */
+        bool shouldStreamFromDisk(const double lengthSeconds) const;
+
         ///**
         // * This is called when the host updates it's sampleRate
         // */
         void setHostSampleRate(const double currentSampleRate);
 
+        /**
+         * Turns converting audio to the host's sample rate on or off. While on, which is the
+         * default, audio held in memory at another rate is converted in the background, and
+         * notes played after that at the root pitch read it without resampling
+         */
+        void setSampleRateConversion(const bool shouldConvert);
+
         //void setHostBlockSize(const uint blockSize);
 
         /**
-         * This is called when the user clicks the reverse toggle in the UI
+         * This is called when the user clicks the reverse toggle in the UI.
+         * Notes started from the next block on play their sounds backwards, and in LOOP MODE
+         * the slices run down the keyboard instead of up. Neither the audio nor the sounds
+         * change, so this costs the same however long the audio is.
          */
         void setReverse(const bool isReversed);
 
@@ -64,11 +115,39 @@ class TwoShotSynth
          */
         void setDecay(const double decaySeconds);
 
+        /**
+         * Chooses whether LOOP MODE audio is cut into bars, or at its transients snapped to a
+         * grid of gridStepsPerBar. Until the transients of new audio are found, it is cut into bars
+         */
+        void setSlicing(const TwoShotSlicer::Slicing slicing);
+
         /**
          * This is called when the user changes the pitch, from within the UI
          */
         void setDetune(const double detuneAmount);
 
+        /**
+         * Changes how the voices resample: linear is cheapest, sinc aliases least
+         * when the sample is repitched a long way
+         */
+        void setInterpolation(const TwoShotRenderKernels::Interpolation interpolation);
+
+        /**
+         * Sets how many notes can play at once, adding voices if there aren't enough yet.
+         * Must not be called from the audio thread.
+         */
+        void setPolyphony(const int numVoices);
+
+        /** Chooses which note a new one cuts off when every voice is busy */
+        void setVoiceStealing(const TwoShotVoiceAllocator::Stealing stealing);
+
+        /**
+         * Shares the voices out between the audio thread and this many worker threads whenever
+         * enough are playing, or renders them all on the audio thread with 0, which is the default.
+         * Must not be called from the audio thread.
+         */
+        void setRenderThreads(const int numThreads);
+
         //void setVoiceSampleRate(const uint sampleRate);
 
 
@@ -81,18 +160,155 @@ class TwoShotSynth
             std::optional<const double> currentHostBpm
         );
 
+        /**
+         * Returns how many voices are playing. Only meant for the audio thread, between blocks,
+         * as nothing else stops the count changing while it is read
+         */
+        int getNumPlayingVoices() const noexcept { return m_synth.getNumPlayingVoices(); }
+
+        /** The most sounds a single set may hold, one per bar in LOOP MODE */
+        static constexpr int maxNumSounds = 256;
+
+        /** The notes that can play at once until setPolyphony() is called */
+        static constexpr int defaultPolyphony = 16;
+
+        /** The transients are moved to the nearest of this many steps in a bar */
+        static constexpr int gridStepsPerBar = 16;
+
+        /** Audio beyond this length is ignored, unless it is streamed from disk */
+        static constexpr double maxSampleLengthSeconds = 120;
+
+        /** Audio longer than this is streamed from disk, if disk streaming is on */
+        static constexpr double diskStreamingThresholdSeconds = 30;
+
     private:
-        AudioBuffer<float>* getSamplerAudio(int soundIndex);
-        void setIsLoop(const bool isLoop);
-        void updateADSR();
-        void reverse();
-        juce::Synthesiser m_synth;
-        juce::ADSR::Parameters m_adsrParams;
+        friend class TwoShotStretchCache;
+        friend class TwoShotResampleCache;
+        friend class TwoShotSlicer;
+
+        /**
+         * A juce::Synthesiser whose sounds can be replaced from the audio thread
+         * without allocating or freeing anything, and which finds the sound and voice
+         * for a note without searching for them.
+         */
+        class Engine : public juce::Synthesiser
+        {
+            public:
+                Engine();
+                void installSounds(const TwoShotSoundSet& soundSet);
+
+                /** Chooses whether new notes look their sound up in the reversed note map */
+                void setReversed(bool isReversed) noexcept;
+                void noteOn(int midiChannel, int midiNoteNumber, float velocity) override;
+
+                /**
+                 * Releases the voice the note started, whichever sound it is playing. Reversed,
+                 * a loop's notes play slices that don't apply to them, so juce::Synthesiser,
+                 * which asks the sound, would never let them go.
+                 */
+                void noteOff(int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff) override;
+
+                /**
+                 * Renders the voices straight into outputAudio, stopping at the exact sample of
+                 * every midi event to handle it. Used instead of renderNextBlock(), which splits
+                 * the block at no less than a minimum sub-block size.
+                 */
+                void renderBlock(juce::AudioBuffer<float>& outputAudio, const juce::MidiBuffer& midiData, int startSample, int numSamples);
+
+                TwoShotVoice* addVoice(TwoShotVoice* voice);
+                void setPolyphony(int numVoices);
+                void setVoiceStealing(TwoShotVoiceAllocator::Stealing stealing);
+                void setRenderThreads(int numThreads);
+                int getNumVoices() const noexcept { return m_allocator.getNumVoices(); }
+                int getNumPlayingVoices() const noexcept { return m_allocator.getNumPlaying(); }
+
+                /** Calls function on every voice that is playing, under the synthesiser's lock */
+                template <typename Function>
+                void forEachPlayingVoice(Function&& function)
+                {
+                    const juce::ScopedLock sl(lock);
+                    m_allocator.forEachPlayingVoice(std::forward<Function>(function));
+                }
+
+            protected:
+                void renderVoices(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+
+            private:
+                using NoteMap = std::array<TwoShotSound*, 128>;
+
+                TwoShotVoiceAllocator m_allocator;
+                // the sound each midi note plays forwards and reversed, rebuilt whenever the sounds change
+                std::array<NoteMap, 2> m_noteMaps {};
+                // one of m_noteMaps, swapped by setReversed() without touching the sounds
+                const NoteMap* m_soundForNote = &m_noteMaps[0];
+                // null unless the voices are being shared out
+                std::unique_ptr<TwoShotRenderWorkers> m_workers;
+                // the playing voices, gathered for the workers to claim
+                std::array<TwoShotVoice*, TwoShotVoiceAllocator::maxNumVoices> m_playingVoices {};
+        };
+
+        TwoShotSoundSet* createSoundSet(
+            TwoShotAudioData::Ptr audioData,
+            std::optional<const double> audioBpm,
+            const int beatOffset,
+            const juce::Array<int>* onsets = nullptr
+        );
+        juce::Array<int> getSliceStarts(
+            const int numSamples,
+            const double samplesPerBar,
+            const int beatOffset,
+            const int minSliceLength,
+            const juce::Array<int>* onsets
+        ) const;
+        void sliceAtOnsets(const TwoShotAudioData& audioData, const juce::Array<int>& onsets);
+        void replaceCurrentSoundSet(TwoShotSoundSet* soundSet);
+        void publishSoundSet(TwoShotSoundSet* soundSet);
+        void handOverSoundSet(TwoShotSoundSet* soundSet);
+        void installPendingSoundSet();
+        void crossfadeVoicesTo(const TwoShotSoundSet& soundSet);
+        TwoShotSoundSet::Ptr getSoundSetToStretch();
+        TwoShotSoundSet::Ptr getSoundSetToConvert();
+        bool isCurrentSoundSet(const TwoShotSoundSet& soundSet) const;
+        void publishStretchedSoundSet(TwoShotSoundSet* stretchedSet);
+        void withdrawStretchedSoundSet();
+        void updateVoiceParameters(std::optional<const double> currentHostBpm);
+        // declared before m_synth, so they outlive the voices streaming from and reading them
+        juce::TimeSliceThread m_diskThread;
+        TwoShotVoiceParameters m_voiceParameters;
+        Engine m_synth;
+
+        // set from the UI and picked up by updateVoiceParameters(), which only rebuilds
+        // m_voiceParameters when m_parameterChanges has moved on or the host tempo changed
+        std::atomic<float> m_attack { TwoShotVoiceParameters().envelope.attack };
+        std::atomic<float> m_release { TwoShotVoiceParameters().envelope.release };
+        std::atomic<double> m_detuneRatio { 1.0 };
+        std::atomic<TwoShotRenderKernels::Interpolation> m_interpolation { TwoShotRenderKernels::Interpolation::linear };
+        std::atomic<juce::uint32> m_parameterChanges { 1 };
+        // only touched by the audio thread
+        juce::uint32 m_appliedParameterChanges = 0;
+        double m_hostBpm = 0;
+
         std::atomic<double> m_audioSampleRate;
         std::atomic<double> m_audioBPM;
         std::atomic<bool> m_isReversed;
         std::atomic<bool> m_isLoop;
         std::atomic<int> m_midiNaturalNote;
-        soundtouch::SoundTouch m_soundTouch;
-        std::vector<float> m_buf;
+        std::atomic<bool> m_diskStreaming { true };
+        std::atomic<TwoShotSlicer::Slicing> m_slicing { TwoShotSlicer::Slicing::bars };
+
+        // guards m_currentSet against the UI and loader threads
+        juce::CriticalSection m_setLock;
+        // the most recently built set, may not have reached the audio thread yet
+        TwoShotSoundSet::Ptr m_currentSet;
+        // m_currentSet stretched to the host tempo, if that's what was handed over last
+        TwoShotSoundSet::Ptr m_stretchedSet;
+        // handed from the loader to the audio thread, which swaps it with nullptr
+        std::atomic<TwoShotSoundSet*> m_pendingSet { nullptr };
+        // the set the audio thread is playing, only touched by the audio thread
+        TwoShotSoundSet* m_liveSet = nullptr;
+        TwoShotReleasePool m_releasePool;
+        TwoShotStretchCache m_stretchCache { *this };
+        TwoShotResampleCache m_resampleCache { *this };
+        TwoShotSlicer m_slicer { *this };
+        TwoShotLoader m_loader { *this };
 };
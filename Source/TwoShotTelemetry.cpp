@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    TwoShotTelemetry.cpp
+    Created: 17 Oct 2026 11:32:08pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotTelemetry.h"
+
+TwoShotTelemetry::TwoShotTelemetry() : juce::Thread("TwoShot telemetry")
+{
+    startThread(1);
+}
+
+TwoShotTelemetry::~TwoShotTelemetry()
+{
+    stopThread(1000);
+}
+
+void TwoShotTelemetry::prepare(const double sampleRate) noexcept
+{
+    m_sampleRate = sampleRate;
+}
+
+void TwoShotTelemetry::recordBlock(const juce::int64 renderTicks, const int numVoices, const int numEvents, const int numSamples) noexcept
+{
+    int start1, size1, start2, size2;
+    m_fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 + size2 == 0)
+    {
+        m_numDroppedBlocks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    m_blocks[(size_t) (size1 > 0 ? start1 : start2)] = { renderTicks, m_sampleRate.load(std::memory_order_relaxed), numVoices, numEvents, numSamples };
+    m_fifo.finishedWrite(1);
+}
+
+TwoShotTelemetry::Snapshot TwoShotTelemetry::getSnapshot() const
+{
+    const juce::ScopedLock sl(m_snapshotLock);
+    return m_snapshot;
+}
+
+void TwoShotTelemetry::setLogFile(const juce::File& file)
+{
+    const juce::ScopedLock sl(m_snapshotLock);
+    m_logFile = file;
+}
+
+void TwoShotTelemetry::run()
+{
+    auto windowStart = juce::Time::getMillisecondCounterHiRes();
+
+    while (! threadShouldExit())
+    {
+        // drained more often than published, so a full fifo only means a stalled thread
+        drain();
+
+        const auto now = juce::Time::getMillisecondCounterHiRes();
+        if (now - windowStart >= publishIntervalMs)
+        {
+            publish((now - windowStart) / 1000.0);
+            windowStart = now;
+        }
+        wait(50);
+    }
+}
+
+void TwoShotTelemetry::drain()
+{
+    int start1, size1, start2, size2;
+    m_fifo.prepareToRead(m_fifo.getNumReady(), start1, size1, start2, size2);
+
+    auto addBlocks = [this](int start, int size)
+    {
+        for (int i = start; i < start + size; ++i)
+        {
+            const auto& block = m_blocks[(size_t) i];
+            const double renderSeconds = juce::Time::highResolutionTicksToSeconds(block.renderTicks);
+            const double blockSeconds = block.sampleRate > 0 ? block.numSamples / block.sampleRate : 0.0;
+
+            m_renderMicroseconds.push_back(renderSeconds * 1.0e6);
+            m_loads.push_back(blockSeconds > 0 ? renderSeconds / blockSeconds : 0.0);
+            m_numVoices.push_back(block.numVoices);
+            m_numEvents.push_back(block.numEvents);
+            m_blockSizes.push_back(block.numSamples);
+        }
+    };
+    addBlocks(start1, size1);
+    addBlocks(start2, size2);
+    m_fifo.finishedRead(size1 + size2);
+}
+
+void TwoShotTelemetry::publish(const double windowSeconds)
+{
+    Snapshot snapshot;
+    snapshot.time = juce::Time::getCurrentTime();
+    snapshot.windowSeconds = windowSeconds;
+    snapshot.numBlocks = (juce::int64) m_loads.size();
+
+    const auto numDroppedBlocks = m_numDroppedBlocks.load(std::memory_order_relaxed);
+    snapshot.numDroppedBlocks = numDroppedBlocks - m_lastNumDroppedBlocks;
+    m_lastNumDroppedBlocks = numDroppedBlocks;
+
+    for (const double load : m_loads)
+    {
+        const int bin = juce::jlimit(0, (int) snapshot.loadHistogram.size() - 1, (int) (load * 10.0));
+        ++snapshot.loadHistogram[(size_t) bin];
+        if (load > 1.0)
+        {
+            ++snapshot.numLateBlocks;
+        }
+    }
+
+    snapshot.renderMicroseconds = summarise(m_renderMicroseconds);
+    snapshot.load = summarise(m_loads);
+    snapshot.numVoices = summarise(m_numVoices);
+    snapshot.numEvents = summarise(m_numEvents);
+    snapshot.blockSize = summarise(m_blockSizes);
+
+    // cleared rather than replaced, so the next window reuses their storage
+    for (auto* values : { &m_renderMicroseconds, &m_loads, &m_numVoices, &m_numEvents, &m_blockSizes })
+    {
+        values->clear();
+    }
+
+    juce::File logFile;
+    {
+        const juce::ScopedLock sl(m_snapshotLock);
+        m_snapshot = snapshot;
+        logFile = m_logFile;
+    }
+
+    if (logFile != juce::File())
+    {
+        logFile.appendText(toJson(snapshot) + "\n");
+    }
+}
+
+/**
+* Sorts the values, and picks the percentiles out of them
+*/
+TwoShotTelemetry::Summary TwoShotTelemetry::summarise(std::vector<double>& values)
+{
+    Summary summary;
+    if (values.empty())
+    {
+        return summary;
+    }
+
+    std::sort(values.begin(), values.end());
+    auto percentile = [&values](double fraction)
+    {
+        return values[(size_t) (fraction * (double) (values.size() - 1) + 0.5)];
+    };
+
+    summary.p50 = percentile(0.5);
+    summary.p99 = percentile(0.99);
+    summary.max = values.back();
+    return summary;
+}
+
+juce::String TwoShotTelemetry::toJson(const Snapshot& snapshot)
+{
+    auto summaryToVar = [](const Summary& summary)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("p50", summary.p50);
+        object->setProperty("p99", summary.p99);
+        object->setProperty("max", summary.max);
+        return juce::var(object);
+    };
+
+    juce::Array<juce::var> histogram;
+    for (const auto count : snapshot.loadHistogram)
+    {
+        histogram.add(count);
+    }
+
+    auto* object = new juce::DynamicObject();
+    object->setProperty("time", snapshot.time.toISO8601(true));
+    object->setProperty("windowSeconds", snapshot.windowSeconds);
+    object->setProperty("blocks", snapshot.numBlocks);
+    object->setProperty("lateBlocks", snapshot.numLateBlocks);
+    object->setProperty("droppedBlocks", snapshot.numDroppedBlocks);
+    object->setProperty("renderMicroseconds", summaryToVar(snapshot.renderMicroseconds));
+    object->setProperty("load", summaryToVar(snapshot.load));
+    object->setProperty("voices", summaryToVar(snapshot.numVoices));
+    object->setProperty("events", summaryToVar(snapshot.numEvents));
+    object->setProperty("blockSize", summaryToVar(snapshot.blockSize));
+    object->setProperty("loadHistogram", histogram);
+
+    // all on one line, so a log holds one snapshot per line
+    return juce::JSON::toString(juce::var(object), true);
+}
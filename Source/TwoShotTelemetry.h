@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    TwoShotTelemetry.h
+    Created: 17 Oct 2026 11:32:08pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Keeps track of how close each audio block comes to its deadline.
+ *
+ * The audio thread records the time spent rendering every block, with its voice count,
+ * midi event count and size, into a lock-free fifo. A low priority thread drains it and,
+ * once every publishInterval, summarises the blocks since the last time into a Snapshot
+ * that can be read from any other thread, and optionally appended to a log file as a
+ * line of JSON for a dashboard to pick up.
+ */
+class TwoShotTelemetry : private juce::Thread
+{
+    public:
+        /** The median, 99th percentile and largest of one measurement over a window */
+        struct Summary
+        {
+            double p50 = 0;
+            double p99 = 0;
+            double max = 0;
+        };
+
+        struct Snapshot
+        {
+            juce::Time time;
+            double windowSeconds = 0;
+            juce::int64 numBlocks = 0;
+            /** blocks that took longer to render than they last for */
+            juce::int64 numLateBlocks = 0;
+            /** blocks the audio thread couldn't record, because the fifo was full */
+            juce::int64 numDroppedBlocks = 0;
+
+            Summary renderMicroseconds;
+            /** render time as a fraction of the block's duration, the deadline */
+            Summary load;
+            Summary numVoices;
+            Summary numEvents;
+            Summary blockSize;
+
+            /** how many blocks used 0-10% of their deadline, 10-20% and so on, with everything over 100% in the last bin */
+            std::array<juce::int64, 11> loadHistogram {};
+        };
+
+        TwoShotTelemetry();
+        ~TwoShotTelemetry() override;
+
+        /** Tells the telemetry the sample rate that the blocks' deadlines are worked out from */
+        void prepare(const double sampleRate) noexcept;
+
+        /**
+         * Records one block. Lock-free and allocation-free, called from the audio thread
+         * @param renderTicks the time spent rendering it, in high resolution ticks
+         */
+        void recordBlock(const juce::int64 renderTicks, const int numVoices, const int numEvents, const int numSamples) noexcept;
+
+        /** Returns the summary of the most recent complete window */
+        Snapshot getSnapshot() const;
+
+        /** Appends every snapshot to this file from now on, as one line of JSON each. An empty File stops logging */
+        void setLogFile(const juce::File& file);
+
+        static juce::String toJson(const Snapshot& snapshot);
+
+        static constexpr int fifoSize = 4096;
+        static constexpr int publishIntervalMs = 1000;
+
+    private:
+        struct Block
+        {
+            juce::int64 renderTicks;
+            double sampleRate;
+            int numVoices;
+            int numEvents;
+            int numSamples;
+        };
+
+        void run() override;
+        void drain();
+        void publish(const double windowSeconds);
+        static Summary summarise(std::vector<double>& values);
+
+        juce::AbstractFifo m_fifo { fifoSize };
+        std::array<Block, fifoSize> m_blocks {};
+        std::atomic<double> m_sampleRate { 0 };
+        std::atomic<juce::int64> m_numDroppedBlocks { 0 };
+
+        // the blocks of the window in progress, only touched by the telemetry thread
+        std::vector<double> m_renderMicroseconds;
+        std::vector<double> m_loads;
+        std::vector<double> m_numVoices;
+        std::vector<double> m_numEvents;
+        std::vector<double> m_blockSizes;
+        juce::int64 m_lastNumDroppedBlocks = 0;
+
+        juce::CriticalSection m_snapshotLock;
+        Snapshot m_snapshot;
+        juce::File m_logFile;
+};
@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    TwoShotTempoDetector.cpp
+    Created: 18 Oct 2026 12:48:19am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotTempoDetector.h"
+
+namespace
+{
+    // BPMDetect is fed in blocks of this many samples, which it is allowed to overwrite
+    constexpr int blockSize = 4096;
+
+    // beats detected more weakly than this fraction of the strongest are ignored
+    constexpr float minBeatStrength = 0.25f;
+
+    /** Mixes a block down to mono, which is all BPMDetect needs */
+    void mixDown(const juce::AudioBuffer<float>& source, int sourceStart, int numChannels, int numSamples, float* mono)
+    {
+        juce::FloatVectorOperations::copy(mono, source.getReadPointer(0, sourceStart), numSamples);
+        for (int channel = 1; channel < numChannels; ++channel)
+        {
+            juce::FloatVectorOperations::add(mono, source.getReadPointer(channel, sourceStart), numSamples);
+        }
+        juce::FloatVectorOperations::multiply(mono, 1.0f / numChannels, numSamples);
+    }
+}
+
+std::optional<TwoShotTempoDetector::Tempo> TwoShotTempoDetector::findTempo(const juce::File& file)
+{
+    if (const auto* tempo = m_entries.find(getFileKey(file)))
+    {
+        return *tempo;
+    }
+    return std::nullopt;
+}
+
+std::optional<TwoShotTempoDetector::Tempo> TwoShotTempoDetector::detect(
+    const juce::File& file,
+    const juce::AudioBuffer<float>& buffer,
+    const double sampleRate
+)
+{
+    const auto tempo = analyse(buffer, sampleRate);
+    remember(file, tempo);
+    return tempo;
+}
+
+std::optional<TwoShotTempoDetector::Tempo> TwoShotTempoDetector::detect(const juce::File& file, juce::AudioFormatReader& reader)
+{
+    const auto tempo = analyse(reader);
+    remember(file, tempo);
+    return tempo;
+}
+
+std::optional<TwoShotTempoDetector::Tempo> TwoShotTempoDetector::analyse(const juce::AudioBuffer<float>& buffer, const double sampleRate)
+{
+    std::unique_ptr<soundtouch::BPMDetect> detector(soundtouch::BPMDetect::newInstance(1, juce::roundToInt(sampleRate)));
+    const int numSamples = juce::jmin(buffer.getNumSamples(), (int) (maxAnalysisSeconds * sampleRate));
+    std::vector<float> mono((size_t) blockSize);
+
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        const int numToAnalyse = juce::jmin(blockSize, numSamples - start);
+        mixDown(buffer, start, buffer.getNumChannels(), numToAnalyse, mono.data());
+        detector->inputSamples(mono.data(), numToAnalyse);
+    }
+
+    return findTempo(*detector, sampleRate);
+}
+
+std::optional<TwoShotTempoDetector::Tempo> TwoShotTempoDetector::analyse(juce::AudioFormatReader& reader)
+{
+    std::unique_ptr<soundtouch::BPMDetect> detector(soundtouch::BPMDetect::newInstance(1, juce::roundToInt(reader.sampleRate)));
+    const auto numSamples = juce::jmin(reader.lengthInSamples, (juce::int64) (maxAnalysisSeconds * reader.sampleRate));
+    const int numChannels = juce::jlimit(1, 2, (int) reader.numChannels);
+
+    juce::AudioBuffer<float> block(numChannels, blockSize);
+    std::vector<float> mono((size_t) blockSize);
+
+    for (juce::int64 start = 0; start < numSamples; start += blockSize)
+    {
+        const int numToAnalyse = (int) juce::jmin((juce::int64) blockSize, numSamples - start);
+        reader.read(&block, 0, numToAnalyse, start, true, numChannels > 1);
+        mixDown(block, 0, numChannels, numToAnalyse, mono.data());
+        detector->inputSamples(mono.data(), numToAnalyse);
+    }
+
+    return findTempo(*detector, reader.sampleRate);
+}
+
+std::vector<std::optional<TwoShotTempoDetector::Tempo>> TwoShotTempoDetector::detectFiles(
+    const juce::Array<juce::File>& files,
+    const int numThreads
+)
+{
+    std::vector<std::optional<Tempo>> tempos((size_t) files.size());
+    const int numJobs = juce::jlimit(1, juce::jmax(1, files.size()), numThreads);
+
+    std::atomic<int> nextFile { 0 };
+    std::atomic<int> numJobsRunning { numJobs };
+    juce::WaitableEvent finished;
+
+    // every job keeps claiming files until there are none left, so they all finish together
+    auto analyseFiles = [&]
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        for (int index = nextFile++; index < files.size(); index = nextFile++)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(files.getReference(index)));
+            if (reader != nullptr)
+            {
+                tempos[(size_t) index] = analyse(*reader);
+            }
+        }
+
+        if (--numJobsRunning == 0)
+        {
+            finished.signal();
+        }
+    };
+
+    // waited for before the pool goes, as deleting it would interrupt the jobs
+    juce::ThreadPool pool(numJobs);
+    for (int job = 0; job < numJobs; ++job)
+    {
+        pool.addJob(analyseFiles);
+    }
+    finished.wait();
+
+    for (int index = 0; index < files.size(); ++index)
+    {
+        remember(files.getReference(index), tempos[(size_t) index]);
+    }
+    return tempos;
+}
+
+/**
+* Reads the tempo out of the detector, and lines the beat grid up with the beats it found,
+* by averaging where each one falls within a beat, weighted by how strong it was
+*/
+std::optional<TwoShotTempoDetector::Tempo> TwoShotTempoDetector::findTempo(soundtouch::BPMDetect& detector, const double sampleRate)
+{
+    const double bpm = detector.getBpm();
+    if (bpm <= 0)
+    {
+        return std::nullopt;
+    }
+
+    const int numBeats = detector.getBeats(nullptr, nullptr, 0);
+    std::vector<float> positions((size_t) numBeats);
+    std::vector<float> strengths((size_t) numBeats);
+    detector.getBeats(positions.data(), strengths.data(), numBeats);
+
+    const float maxStrength = numBeats > 0 ? *std::max_element(strengths.begin(), strengths.end()) : 0.0f;
+    const double secondsPerBeat = 60.0 / bpm;
+
+    // beat phases wrap around, so they are averaged as angles
+    double x = 0;
+    double y = 0;
+    for (int i = 0; i < numBeats; ++i)
+    {
+        if (strengths[(size_t) i] < minBeatStrength * maxStrength)
+        {
+            continue;
+        }
+        const double angle = juce::MathConstants<double>::twoPi * std::fmod(positions[(size_t) i], secondsPerBeat) / secondsPerBeat;
+        x += strengths[(size_t) i] * std::cos(angle);
+        y += strengths[(size_t) i] * std::sin(angle);
+    }
+
+    Tempo tempo;
+    tempo.bpm = bpm;
+    if (x != 0 || y != 0)
+    {
+        double phase = std::atan2(y, x) / juce::MathConstants<double>::twoPi;
+        if (phase < 0)
+        {
+            phase += 1.0;
+        }
+        tempo.beatOffset = (int) (phase * secondsPerBeat * sampleRate);
+    }
+    return tempo;
+}
+
+/**
+* Identifies a file by its path, size and modification time, so it can be looked up without reading it
+*/
+juce::uint64 TwoShotTempoDetector::getFileKey(const juce::File& file)
+{
+    const auto path = file.getFullPathName().hashCode64();
+    return (juce::uint64) path
+        ^ ((juce::uint64) file.getSize() * 1099511628211ull)
+        ^ ((juce::uint64) file.getLastModificationTime().toMilliseconds() * 14695981039346656037ull);
+}
+
+void TwoShotTempoDetector::remember(const juce::File& file, std::optional<Tempo> tempo)
+{
+    if (! tempo.has_value())
+    {
+        return;
+    }
+
+    m_entries.insert(getFileKey(file), *tempo);
+}
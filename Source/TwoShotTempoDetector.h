@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    TwoShotTempoDetector.h
+    Created: 18 Oct 2026 12:48:19am
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <ea_soundtouch/ea_soundtouch.h>
+#include "TwoShotLruCache.h"
+
+/**
+ * Finds the tempo and beat grid of a loop that was loaded without a BPM, with SoundTouch's
+ * BPMDetect.
+ *
+ * Only the first maxAnalysisSeconds of the audio are listened to, so a long file costs no
+ * more than a short one. Results are kept in an LRU keyed by the file, so loading the same
+ * loop again doesn't analyse it again. Only used from the loader thread, so nothing is locked.
+ *
+ * Importing a library analyses many files at once with detectFiles(), which shares them out
+ * between a pool of threads.
+ */
+class TwoShotTempoDetector
+{
+    public:
+        struct Tempo
+        {
+            double bpm = 0;
+            /** where the beat grid starts in the audio, in samples, less than one beat in */
+            int beatOffset = 0;
+        };
+
+        /** Returns the tempo found earlier for this file, if there was one and it hasn't changed since */
+        std::optional<Tempo> findTempo(const juce::File& file);
+
+        /** Finds the tempo of decoded audio, and remembers it for the file it came from */
+        std::optional<Tempo> detect(const juce::File& file, const juce::AudioBuffer<float>& buffer, const double sampleRate);
+
+        /** Finds the tempo of audio read from the file, and remembers it */
+        std::optional<Tempo> detect(const juce::File& file, juce::AudioFormatReader& reader);
+
+        /** Finds the tempo of decoded audio, without remembering it */
+        static std::optional<Tempo> analyse(const juce::AudioBuffer<float>& buffer, const double sampleRate);
+
+        /** Finds the tempo of the audio a reader reads, without remembering it */
+        static std::optional<Tempo> analyse(juce::AudioFormatReader& reader);
+
+        /**
+         * Finds the tempo of every file, on numThreads threads, and adds them to those remembered.
+         * Each thread takes the next file not yet started whenever it finishes one, so a few
+         * long files don't hold the rest up. Blocks until all the files are done.
+         * @return the tempo of each file, in the same order, or nullopt where none was found
+         */
+        std::vector<std::optional<Tempo>> detectFiles(const juce::Array<juce::File>& files, const int numThreads);
+
+        /** How much of the audio is analysed */
+        static constexpr double maxAnalysisSeconds = 30;
+
+        /** The most files whose tempo is kept at once */
+        static constexpr int maxNumEntries = 64;
+
+    private:
+        static juce::uint64 getFileKey(const juce::File& file);
+        static std::optional<Tempo> findTempo(soundtouch::BPMDetect& detector, const double sampleRate);
+        void remember(const juce::File& file, std::optional<Tempo> tempo);
+
+        TwoShotLruCache<juce::uint64, Tempo> m_entries { maxNumEntries };
+};
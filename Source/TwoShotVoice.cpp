@@ -10,12 +10,31 @@ Author:  Deuel Lab
 
 #include "TwoShotVoice.h"
 #include "TwoShotSound.h"
+#include "TwoShotRenderKernels.h"
 
-TwoShotVoice::TwoShotVoice() {
+TwoShotVoice::TwoShotVoice(TimeSliceThread& diskThread, const TwoShotVoiceParameters& sharedParameters) :
+    parameters(sharedParameters),
+    stretchInput(2, TwoShotStretcher::blockSize),
+    fadeOutBuffer(2, renderBlockSize),
+    fadeInBuffer(2, renderBlockSize),
+    diskStream(diskThread),
+    streamWindow(2, streamWindowSize)
+{
 
 }
 TwoShotVoice::~TwoShotVoice() {}
 
+void TwoShotVoice::setCurrentPlaybackSampleRate(double newRate)
+{
+    SynthesiserVoice::setCurrentPlaybackSampleRate(newRate);
+
+    if (newRate > 0)
+    {
+        stretcher.setSampleRate(newRate);
+        envelope.setSampleRate(newRate);
+    }
+}
+
 bool TwoShotVoice::canPlaySound(SynthesiserSound* sound)
 {
     return dynamic_cast<const TwoShotSound*> (sound) != nullptr;
@@ -23,21 +42,36 @@ bool TwoShotVoice::canPlaySound(SynthesiserSound* sound)
 
 void TwoShotVoice::startNote(int midiNoteNumber, float velocity, SynthesiserSound* s, int /*currentPitchWheelPosition*/)
 {
-    if (auto* sound = dynamic_cast<const TwoShotSound*> (s))
+    if (auto* sound = dynamic_cast<TwoShotSound*> (s))
     {
-        pitchRatio = std::pow(2.0, (midiNoteNumber - sound->midiRootNote) / 12.0) 
+        // the slices of a loop play at their own pitch on whichever note they are mapped to,
+        // which changes with the direction
+        const int rootNote = parameters.isLoop ? midiNoteNumber : sound->midiRootNote;
+        pitchRatio = std::pow(2.0, (midiNoteNumber - rootNote) / 12.0)
             * sound->sourceSampleRate / getSampleRate();
 
 
+        playingSound = sound;
+        incomingSound = nullptr;
+        isReversed = parameters.isReversed;
         sourceSamplePosition = 0.0;
-        lgain = velocity;
-        lgain = velocity;
-        rgain = velocity;
+        basePosition = 0.0;
+        gain = velocity;
+        level = 0.0f;
+
+        envelope.setParameters(parameters.envelope);
+        envelope.noteOn();
 
-        adsr.setSampleRate(sound->sourceSampleRate);
-        adsr.setParameters(sound->params);
+        // loops keep their pitch and are time-stretched to the host tempo instead,
+        // unless the sound was stretched to it ahead of time
+        isStretching = parameters.isLoop && TwoShotStretcher::isStretch(parameters.bpmCompRatio / sound->tempoRatio);
+        stretchInputEnded = false;
+        stretcher.reset();
 
-        adsr.noteOn();
+        if (sound->isStreamed())
+        {
+            diskStream.start(sound->data.get(), sound->offset, sound->length, sound->streamHeadLength, isReversed);
+        }
     }
     else
     {
@@ -49,85 +83,488 @@ void TwoShotVoice::stopNote(float /*velocity*/, bool allowTailOff)
 {
     if (allowTailOff)
     {
-        adsr.noteOff();
+        envelope.noteOff();
     }
     else
     {
+        // let go of the audio before the sound, so the disk thread never holds the last reference
+        diskStream.stop();
+        playingSound = nullptr;
+        incomingSound = nullptr;
         clearCurrentNote();
-        adsr.reset();
+        envelope.reset();
     }
 }
 
 void TwoShotVoice::pitchWheelMoved(int /*newValue*/) {}
 void TwoShotVoice::controllerMoved(int /*controllerNumber*/, int /*newValue*/) {}
 
-void TwoShotVoice::setDetune(double newValue)
+const TwoShotSound* TwoShotVoice::getOriginalSound() const noexcept
 {
-    detuneRatio = std::pow(2.0, (newValue / 1200.0));
+    return playingSound != nullptr ? playingSound->getOriginal() : nullptr;
+}
+
+void TwoShotVoice::crossfadeTo(TwoShotSound* sound)
+{
+    if (playingSound == nullptr || sound == playingSound.get())
+    {
+        return;
+    }
+
+    if (TwoShotStretcher::isStretch(parameters.bpmCompRatio / sound->tempoRatio))
+    {
+        // the fade can't stretch, so the original takes over straight away, as it does
+        // when the host tempo moves off a copy's
+        if (sound->getOriginal() == sound)
+        {
+            playingSound = sound;
+            incomingSound = nullptr;
+            isStretching = true;
+            stretchInputEnded = false;
+            stretcher.reset();
+            sourceSamplePosition = basePosition;
+        }
+        return;
+    }
 
+    incomingSound = sound;
+    incomingPosition = basePosition / sound->tempoRatio;
+    crossfadePosition = 0;
 }
 
-void TwoShotVoice::setBPMComp(double audioBPM, double hostBPM)
+float TwoShotVoice::getLevel() const noexcept
 {
-    bpmCompRatio = (hostBPM / audioBPM);
-    soundTouch.setPitchOctaves(1.0);
+    return isVoiceActive() ? level : 0.0f;
 }
 
-void TwoShotVoice::setIsLoop(bool newValue)
+/**
+* Fills gains with the envelope times the velocity, or with 1 when the envelope is applied later
+*/
+void TwoShotVoice::fillGains(int numSamples, bool applyEnvelope) noexcept
+{
+    if (! applyEnvelope)
+    {
+        std::fill(gains.begin(), gains.begin() + numSamples, 1.0f);
+    }
+    else if (envelope.isFlat())
+    {
+        // held at the sustain level, every sample gets the same gain
+        level = envelope.getLevel() * gain;
+        std::fill(gains.begin(), gains.begin() + numSamples, level);
+    }
+    else
+    {
+        envelope.render(gains.data(), numSamples, gain);
+        level = gains[(size_t) (numSamples - 1)];
+    }
+}
+
+double TwoShotVoice::getIncrement(const TwoShotSound& sound) const noexcept
 {
-    isLoop = newValue;
+    if (isStretching)
+    {
+        return pitchRatio;
+    }
+    return parameters.isLoop ? pitchRatio * parameters.bpmCompRatio / sound.tempoRatio : pitchRatio * parameters.detuneRatio;
 }
 
 //==============================================================================
 void TwoShotVoice::renderNextBlock(AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
 {
-    if (auto* playingSound = static_cast<TwoShotSound*> (getCurrentlyPlayingSound().get()))
+    if (playingSound == nullptr)
     {
-        auto& data = *playingSound->data;
-        const float* const inL = data.getReadPointer(0);
-        const float* const inR = data.getNumChannels() > 1 ? data.getReadPointer(1) : nullptr;
+        return;
+    }
 
-        float* outL = outputBuffer.getWritePointer(0, startSample);
-        float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer(1, startSample) : nullptr;
-        while (--numSamples >= 0)
+    updateStretching();
+
+    const bool isPlaying = incomingSound != nullptr
+        ? renderCrossfade(outputBuffer, startSample, numSamples)
+        : renderPlayingSound(outputBuffer, startSample, numSamples, true);
+
+    basePosition += numSamples * pitchRatio * parameters.bpmCompRatio;
+
+    // once the release is over there is nothing left to hear
+    if (! isPlaying || ! envelope.isActive())
+    {
+        stopNote(0.0f, false);
+    }
+}
+
+/**
+* Starts or stops time-stretching when the host tempo moves onto or off the tempo
+* the playing sound was stretched to ahead of time
+*/
+void TwoShotVoice::updateStretching()
+{
+    const bool shouldStretch = parameters.isLoop && TwoShotStretcher::isStretch(parameters.bpmCompRatio / playingSound->tempoRatio);
+
+    if (shouldStretch != isStretching)
+    {
+        isStretching = shouldStretch;
+        stretchInputEnded = false;
+        stretcher.reset();
+
+        // the stretcher runs ahead of what has been heard, so pick up from what has been heard.
+        // A disk stream can only move forwards, so streamed sounds carry on from where they are
+        if (! playingSound->isStreamed())
         {
-            auto pos = (int)sourceSamplePosition;
-            auto alpha = (float)(sourceSamplePosition - pos);
-            auto invAlpha = 1.0f - alpha;
+            sourceSamplePosition = basePosition / playingSound->tempoRatio;
+        }
+    }
+}
 
-            // just using a very simple linear interpolation here..
-            float l = (inL[pos] * invAlpha + inL[pos + 1] * alpha);
-            float r = (inR != nullptr) ? (inR[pos] * invAlpha + inR[pos + 1] * alpha)
-                : l;
+bool TwoShotVoice::renderPlayingSound(AudioBuffer<float>& outputBuffer, int startSample, int numSamples, bool applyEnvelope)
+{
+    return isStretching
+        ? renderStretched(*playingSound, outputBuffer, startSample, numSamples, applyEnvelope)
+        : renderSource(*playingSound, outputBuffer, startSample, numSamples, applyEnvelope);
+}
+
+/**
+* Renders the stretched copy being faded in, without the envelope, from the start of outputBuffer
+*/
+bool TwoShotVoice::renderIncomingSound(AudioBuffer<float>& outputBuffer, int numSamples)
+{
+    const auto& sound = *incomingSound;
 
-            auto envelopeValue = adsr.getNextSample();
+    // the copy already plays at the host tempo, so only the pitch moves it along
+    return renderFromMemory(sound, outputBuffer, 0, numSamples, false,
+                            incomingPosition, pitchRatio * parameters.bpmCompRatio / sound.tempoRatio);
+}
 
-            l *= lgain * envelopeValue;
-            r *= rgain * envelopeValue;
+/**
+* Renders the playing sound and the incoming one into the fade buffers, mixes them with
+* linear ramps and applies the envelope. Once the fade is over, the incoming sound takes over.
+* @return false once the incoming sound, or the one that took over, has ended
+*/
+bool TwoShotVoice::renderCrossfade(AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    const int numChannels = jmin(2, outputBuffer.getNumChannels());
+
+    while (numSamples > 0)
+    {
+        const int numToRender = jmin(numSamples, (int) renderBlockSize, crossfadeLength - crossfadePosition);
 
-            if (outR != nullptr)
+        // views of the preallocated buffers with as many channels as the output, so a stereo sound is mixed down the same way
+        AudioBuffer<float> fadeOut(fadeOutBuffer.getArrayOfWritePointers(), numChannels, numToRender);
+        AudioBuffer<float> fadeIn(fadeInBuffer.getArrayOfWritePointers(), numChannels, numToRender);
+        fadeOut.clear();
+        fadeIn.clear();
+
+        // the playing sound ending during the fade just leaves silence to fade from
+        renderPlayingSound(fadeOut, 0, numToRender, false);
+        const bool incomingIsPlaying = renderIncomingSound(fadeIn, numToRender);
+
+        fillGains(numToRender, true);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* from = fadeOut.getReadPointer(channel);
+            const float* to = fadeIn.getReadPointer(channel);
+            float* out = outputBuffer.getWritePointer(channel, startSample);
+
+            for (int i = 0; i < numToRender; ++i)
             {
-                *outL++ += l;
-                *outR++ += r;
+                const float amount = (float) (crossfadePosition + i) / (float) crossfadeLength;
+                out[i] += (from[i] + (to[i] - from[i]) * amount) * gains[(size_t) i];
             }
-            else
+        }
+
+        crossfadePosition += numToRender;
+        startSample += numToRender;
+        numSamples -= numToRender;
+
+        if (! incomingIsPlaying)
+        {
+            return false;
+        }
+
+        if (crossfadePosition >= crossfadeLength)
+        {
+            finishCrossfade();
+            return numSamples == 0 || renderPlayingSound(outputBuffer, startSample, numSamples, true);
+        }
+    }
+    return true;
+}
+
+/**
+* Hands playback over to the incoming sound. The sound it replaces is still held by its
+* set, so nothing is freed on the audio thread.
+*/
+void TwoShotVoice::finishCrossfade()
+{
+    diskStream.stop();
+    playingSound = incomingSound;
+    incomingSound = nullptr;
+    sourceSamplePosition = incomingPosition;
+
+    // crossfadeTo() only takes copies stretched to the current host tempo
+    isStretching = false;
+}
+
+/**
+* Renders the sound at getIncrement(), with or without the envelope
+* @return false once the end of the sound was reached
+*/
+bool TwoShotVoice::renderSource(
+    const TwoShotSound& sound,
+    AudioBuffer<float>& outputBuffer,
+    int startSample,
+    int numSamples,
+    bool applyEnvelope)
+{
+    if (sound.isStreamed())
+    {
+        return renderStreamed(sound, outputBuffer, startSample, numSamples, applyEnvelope);
+    }
+
+    return renderFromMemory(sound, outputBuffer, startSample, numSamples, applyEnvelope,
+                            sourceSamplePosition, getIncrement(sound));
+}
+
+/**
+* Renders a sound held in memory, reading its region forwards, or backwards from its end
+* when the note is reversed. The audio itself is never touched, so it can be shared with
+* notes playing the other way.
+*/
+bool TwoShotVoice::renderFromMemory(
+    const TwoShotSound& sound,
+    AudioBuffer<float>& outputBuffer,
+    int startSample,
+    int numSamples,
+    bool applyEnvelope,
+    double& position,
+    double increment)
+{
+    const auto& data = *sound.data;
+
+    // backwards, in[i] is frame length - i in playing order, starting a frame before the
+    // region so the positions the kernels step down through never go below zero
+    const int firstSample = isReversed ? sound.offset - 1 : sound.offset;
+    const int firstFrame = isReversed ? sound.length : 0;
+    const float* const inL = data.getReadPointer(0, firstSample);
+    const float* const inR = data.numChannels > 1 ? data.getReadPointer(1, firstSample) : nullptr;
+
+    return render(sound, inL, inR, firstFrame, isReversed, outputBuffer, startSample, numSamples, applyEnvelope,
+                  position, increment);
+}
+
+/**
+* Renders a loop at its own pitch and the host's tempo. The source is rendered into the
+* stretcher a block at a time, running ahead by the stretcher's latency at the start of
+* the note, and the envelope is applied to what comes out.
+* @return false once everything the sound makes has been played
+*/
+bool TwoShotVoice::renderStretched(
+    const TwoShotSound& sound,
+    AudioBuffer<float>& outputBuffer,
+    int startSample,
+    int numSamples,
+    bool applyEnvelope)
+{
+    constexpr int blockSize = TwoShotStretcher::blockSize;
+
+    // a sound that was stretched ahead of time only needs stretching the rest of the way
+    stretcher.setTempo(parameters.bpmCompRatio / sound.tempoRatio);
+
+    while (numSamples > 0)
+    {
+        int numToRender = jmin(numSamples, blockSize);
+
+        while (stretcher.getNumReady() < numToRender)
+        {
+            if (stretchInputEnded)
             {
-                *outL = (l + r) * 0.5f;
+                // silence pushes the end of the sound out of the stretcher
+                if (stretcher.getNumReady() >= numStretchedToPlay)
+                {
+                    break;
+                }
+                stretcher.putBlock(nullptr, nullptr, blockSize);
+                continue;
             }
-            if (isLoop)
+
+            stretchInput.clear();
+            stretchInputEnded = ! renderSource(sound, stretchInput, 0, blockSize, false);
+            stretcher.putBlock(stretchInput.getReadPointer(0), stretchInput.getReadPointer(1), blockSize);
+
+            if (stretchInputEnded)
             {
-                sourceSamplePosition += (pitchRatio * bpmCompRatio);
+                numStretchedToPlay = stretcher.getNumFramesToCome();
             }
-            else
+        }
+
+        numToRender = jmin(numToRender, stretcher.getNumReady());
+        if (stretchInputEnded)
+        {
+            numToRender = jmin(numToRender, numStretchedToPlay);
+        }
+        if (numToRender <= 0)
+        {
+            return false;
+        }
+
+        fillGains(numToRender, applyEnvelope);
+
+        float* const out[] = {
+            outputBuffer.getWritePointer(0, startSample),
+            outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer(1, startSample) : nullptr
+        };
+        stretcher.addTo(out, jmin(2, outputBuffer.getNumChannels()), gains.data(), numToRender);
+
+        if (stretchInputEnded)
+        {
+            numStretchedToPlay -= numToRender;
+        }
+        startSample += numToRender;
+        numSamples -= numToRender;
+    }
+    return true;
+}
+
+/**
+* Renders a streamed sound in chunks, gathering the frames each chunk interpolates
+* between into streamWindow, from the preloaded head or the disk stream.
+* The window starts numTapsBefore frames before the first position of the chunk.
+*/
+bool TwoShotVoice::renderStreamed(
+    const TwoShotSound& sound,
+    AudioBuffer<float>& outputBuffer,
+    int startSample,
+    int numSamples,
+    bool applyEnvelope)
+{
+    const double increment = getIncrement(sound);
+    const auto& head = isReversed ? sound.streamHeadReversed : sound.streamHead;
+    const int headLength = sound.streamHeadLength;
+
+    constexpr int tapsBefore = TwoShotRenderKernels::numTapsBefore;
+    constexpr int tapsAfter = TwoShotRenderKernels::numTapsAfter;
+
+    while (numSamples > 0)
+    {
+        const int numToRender = jlimit(1, numSamples, (int) ((streamWindowSize - TwoShotRenderKernels::sincNumTaps - 1) / increment));
+        const int firstFrame = (int) sourceSamplePosition;
+        const int windowStart = firstFrame - tapsBefore;
+        const int numFrames = jmin(
+            streamWindowSize,
+            (int) (sourceSamplePosition + numToRender * increment) - firstFrame + tapsBefore + tapsAfter + 1);
+
+        // frames before the start of the sound are silent
+        const int numSilent = jlimit(0, numFrames, -windowStart);
+        if (numSilent > 0)
+        {
+            streamWindow.clear(0, numSilent);
+        }
+
+        const int numFromHead = jlimit(0, numFrames - numSilent, headLength - (windowStart + numSilent));
+        if (numFromHead > 0)
+        {
+            for (int channel = 0; channel < streamWindow.getNumChannels(); ++channel)
             {
-                sourceSamplePosition += (pitchRatio * detuneRatio);
+                streamWindow.copyFrom(channel, numSilent, head, channel, windowStart + numSilent, numFromHead);
             }
+        }
+
+        const int numGathered = numSilent + numFromHead;
+        if (numGathered < numFrames)
+        {
+            diskStream.read(streamWindow, numGathered, windowStart + numGathered - headLength, numFrames - numGathered);
+        }
+
+        // the window already holds the frames in the order they play
+        if (! render(sound, streamWindow.getReadPointer(0, tapsBefore), streamWindow.getReadPointer(1, tapsBefore),
+                     firstFrame, false, outputBuffer, startSample, numToRender, applyEnvelope, sourceSamplePosition, increment))
+        {
+            return false;
+        }
 
-            if (sourceSamplePosition > playingSound->length)
+        diskStream.release((int) sourceSamplePosition - tapsBefore - headLength);
+        startSample += numToRender;
+        numSamples -= numToRender;
+    }
+    return true;
+}
+
+/**
+* Renders from source audio where inL[i] and inR[i] hold frame firstFrame + i of the sound,
+* or frame firstFrame - i if backwards, moving position through the sound by increment each sample
+* @return false once the end of the sound was reached
+*/
+bool TwoShotVoice::render(
+    const TwoShotSound& sound,
+    const float* inL,
+    const float* inR,
+    int firstFrame,
+    bool backwards,
+    AudioBuffer<float>& outputBuffer,
+    int startSample,
+    int numSamples,
+    bool applyEnvelope,
+    double& position,
+    double increment)
+{
+    // the tail of a slice is faded out here rather than baked into a copy of the audio
+    const double fadeStart = sound.length - sound.fadeLength;
+    const double fadeScale = sound.fadeLength > 0 ? 1.0 / sound.fadeLength : 0.0;
+
+    while (numSamples > 0)
+    {
+        // every position up to and including sound.length is played, so the end of the
+        // sound is worked out once per block rather than tested on every sample
+        const double remaining = sound.length - position;
+        const int numUntilEnd = remaining < 0.0 ? 0 : (int) (remaining / increment) + 1;
+        const int numToRender = jmin(numSamples, numUntilEnd, (int) renderBlockSize);
+
+        if (numToRender == 0)
+        {
+            return false;
+        }
+
+        fillGains(numToRender, applyEnvelope);
+
+        if (position + (numToRender - 1) * increment > fadeStart)
+        {
+            for (int i = jmax(0, (int) ((fadeStart - position) / increment)); i < numToRender; ++i)
             {
-                stopNote(0.0f, false);
-                break;
+                const double samplePosition = position + i * increment;
+                if (samplePosition > fadeStart)
+                {
+                    gains[(size_t) i] *= (float) jmax(0.0, (sound.length - samplePosition) * fadeScale);
+                }
             }
         }
+
+        // backwards, the kernels step down through the frames as position moves up. When every
+        // position lands on a frame, as at the root pitch, they copy rather than interpolate
+        const double readPosition = backwards ? firstFrame - position : position - firstFrame;
+        const double readIncrement = backwards ? -increment : increment;
+        float* outL = outputBuffer.getWritePointer(0, startSample);
+
+        if (outputBuffer.getNumChannels() > 1)
+        {
+            // a mono sound plays the same audio on both sides
+            float* const out[] = { outL, outputBuffer.getWritePointer(1, startSample) };
+            const float* const in[] = { inL, inR != nullptr ? inR : inL };
+            TwoShotRenderKernels::add<2>(parameters.interpolation, out, in, readPosition, readIncrement, gains.data(), numToRender);
+        }
+        else if (inR != nullptr)
+        {
+            // a stereo sound is mixed down to a mono output
+            FloatVectorOperations::multiply(gains.data(), 0.5f, numToRender);
+            TwoShotRenderKernels::add<1>(parameters.interpolation, &outL, &inL, readPosition, readIncrement, gains.data(), numToRender);
+            TwoShotRenderKernels::add<1>(parameters.interpolation, &outL, &inR, readPosition, readIncrement, gains.data(), numToRender);
+        }
+        else
+        {
+            TwoShotRenderKernels::add<1>(parameters.interpolation, &outL, &inL, readPosition, readIncrement, gains.data(), numToRender);
+        }
+
+        position += numToRender * increment;
+        startSample += numToRender;
+        numSamples -= numToRender;
     }
-}
\ No newline at end of file
+    return true;
+}
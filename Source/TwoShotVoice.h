@@ -12,6 +12,13 @@ Author:  Deuel Lab
 
 #include <JuceHeader.h>
 #include <ea_soundtouch/ea_soundtouch.h>
+#include "TwoShotDiskStream.h"
+#include "TwoShotEnvelope.h"
+#include "TwoShotRenderKernels.h"
+#include "TwoShotStretcher.h"
+#include "TwoShotVoiceParameters.h"
+
+class TwoShotSound;
 
 //==============================================================================
 /**
@@ -27,8 +34,11 @@ class TwoShotVoice : public SynthesiserVoice
 {
 public:
     //==============================================================================
-    /** Creates a TwoShotVoice. */
-    TwoShotVoice();
+    /**
+     * Creates a TwoShotVoice, which streams long sounds with the help of diskThread.
+     * The shared parameters are owned by the synth, and only change between blocks.
+     */
+    TwoShotVoice(TimeSliceThread& diskThread, const TwoShotVoiceParameters& sharedParameters);
 
     /** Destructor. */
     ~TwoShotVoice() override;
@@ -37,6 +47,7 @@ public:
 
     void setSampleRate(uint sampleRate);
     void setBlockSize(uint blockSize);
+    void setCurrentPlaybackSampleRate(double newRate) override;
 
     bool canPlaySound(SynthesiserSound*) override;
 
@@ -46,9 +57,19 @@ public:
     void pitchWheelMoved(int newValue) override;
     void controllerMoved(int controllerNumber, int newValue) override;
 
-    void setDetune(double newValue);
-    void setBPMComp(double audioBPM, double hostBPM);
-    void setIsLoop(bool newValue);
+    /** Returns the sound this voice is playing, or the one it is a stretched copy of */
+    const TwoShotSound* getOriginalSound() const noexcept;
+
+    /**
+     * Fades from the sound being played to a stretched copy of it, or back to the original,
+     * picking up at the same point in the loop. A copy is ignored unless it was stretched to
+     * the current host tempo. An original that needs stretching is switched to without a fade,
+     * and stretched from there by the voice.
+     */
+    void crossfadeTo(TwoShotSound* sound);
+
+    /** Returns the envelope and velocity the last sample was played at, for choosing a voice to steal */
+    float getLevel() const noexcept;
 
     void renderNextBlock(AudioBuffer<float>&, int startSample, int numSamples) override;
     using SynthesiserVoice::renderNextBlock;
@@ -56,15 +77,89 @@ public:
 
 private:
     //==============================================================================
+    bool render(
+        const TwoShotSound& sound,
+        const float* inL,
+        const float* inR,
+        int firstFrame,
+        bool backwards,
+        AudioBuffer<float>& outputBuffer,
+        int startSample,
+        int numSamples,
+        bool applyEnvelope,
+        double& position,
+        double increment);
+    bool renderFromMemory(
+        const TwoShotSound& sound,
+        AudioBuffer<float>& outputBuffer,
+        int startSample,
+        int numSamples,
+        bool applyEnvelope,
+        double& position,
+        double increment);
+    bool renderStreamed(
+        const TwoShotSound& sound,
+        AudioBuffer<float>& outputBuffer,
+        int startSample,
+        int numSamples,
+        bool applyEnvelope);
+    bool renderSource(
+        const TwoShotSound& sound,
+        AudioBuffer<float>& outputBuffer,
+        int startSample,
+        int numSamples,
+        bool applyEnvelope);
+    bool renderStretched(
+        const TwoShotSound& sound,
+        AudioBuffer<float>& outputBuffer,
+        int startSample,
+        int numSamples,
+        bool applyEnvelope);
+    bool renderPlayingSound(AudioBuffer<float>& outputBuffer, int startSample, int numSamples, bool applyEnvelope);
+    bool renderIncomingSound(AudioBuffer<float>& outputBuffer, int numSamples);
+    bool renderCrossfade(AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
+    void finishCrossfade();
+    void updateStretching();
+    double getIncrement(const TwoShotSound& sound) const noexcept;
+    void fillGains(int numSamples, bool applyEnvelope) noexcept;
+
+    const TwoShotVoiceParameters& parameters;
+
     double pitchRatio = 0;
-    double detuneRatio = 1;
-    double  bpmCompRatio = 1;
     double sourceSamplePosition = 0;
-    float lgain = 0, rgain = 0;
-    bool isLoop = false;
-    soundtouch::SoundTouch soundTouch;
-
-    ADSR adsr;
+    float gain = 0;
+    float level = 0;
+
+    TwoShotStretcher stretcher;
+    AudioBuffer<float> stretchInput;
+    bool isStretching = false;
+    bool stretchInputEnded = false;
+    int numStretchedToPlay = 0;
+
+    // held here as well as by the base class, as it changes when a stretched copy takes over
+    ReferenceCountedObjectPtr<TwoShotSound> playingSound;
+    // how far into the original sound has been heard, which carries over onto stretched copies
+    double basePosition = 0;
+
+    ReferenceCountedObjectPtr<TwoShotSound> incomingSound;
+    double incomingPosition = 0;
+    int crossfadePosition = 0;
+    static constexpr int crossfadeLength = 1024;
+    AudioBuffer<float> fadeOutBuffer;
+    AudioBuffer<float> fadeInBuffer;
+
+    // the way round this note plays its sounds, chosen when it starts
+    bool isReversed = false;
+
+    TwoShotDiskStream diskStream;
+    AudioBuffer<float> streamWindow;
+    static constexpr int streamWindowSize = 4096;
+
+    TwoShotEnvelope envelope;
+
+    /** The envelope, velocity and fade for each sample of the block being rendered */
+    static constexpr int renderBlockSize = 256;
+    std::array<float, renderBlockSize> gains {};
 
     JUCE_LEAK_DETECTOR(TwoShotVoice);
 };
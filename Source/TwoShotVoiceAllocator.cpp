@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    TwoShotVoiceAllocator.cpp
+    Created: 17 Oct 2026 8:52:17pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#include "TwoShotVoiceAllocator.h"
+
+TwoShotVoiceAllocator::TwoShotVoiceAllocator()
+{
+    m_voiceForNote.fill(-1);
+}
+
+void TwoShotVoiceAllocator::addVoice(TwoShotVoice* voice)
+{
+    jassert(m_numVoices < maxNumVoices);
+    m_voices[(size_t) m_numVoices++] = voice;
+}
+
+void TwoShotVoiceAllocator::setPolyphony(int numVoices)
+{
+    m_polyphony = jlimit(0, m_numVoices, numVoices);
+
+    // pushed in reverse, so the lowest voices are handed out first
+    m_numFree = 0;
+    for (int index = m_polyphony; --index >= 0;)
+    {
+        if (! m_isPlaying[(size_t) index])
+        {
+            m_free[(size_t) m_numFree++] = index;
+        }
+    }
+}
+
+TwoShotVoice* TwoShotVoiceAllocator::allocate(int midiNoteNumber, bool canSteal)
+{
+    if (m_numFree == 0)
+    {
+        // voices stopped outside renderVoices(), e.g. by allNotesOff(), are only noticed here
+        freeFinishedVoices();
+    }
+
+    int index = -1;
+    if (m_numFree > 0)
+    {
+        index = m_free[(size_t) --m_numFree];
+    }
+    else if (canSteal)
+    {
+        index = findVoiceToSteal(midiNoteNumber);
+        if (index >= 0)
+        {
+            // startVoice() cuts off the note it was playing
+            unlink(index);
+        }
+    }
+
+    if (index < 0)
+    {
+        return nullptr;
+    }
+
+    startPlaying(index);
+    if (isPositiveAndBelow(midiNoteNumber, (int) m_voiceForNote.size()))
+    {
+        m_voiceForNote[(size_t) midiNoteNumber] = index;
+    }
+    return m_voices[(size_t) index];
+}
+
+TwoShotVoice* TwoShotVoiceAllocator::findVoicePlaying(int midiNoteNumber, int midiChannel) const noexcept
+{
+    if (! isPositiveAndBelow(midiNoteNumber, (int) m_voiceForNote.size()))
+    {
+        return nullptr;
+    }
+
+    const int index = m_voiceForNote[(size_t) midiNoteNumber];
+    if (index < 0)
+    {
+        return nullptr;
+    }
+
+    auto* voice = m_voices[(size_t) index];
+    return voice->getCurrentlyPlayingNote() == midiNoteNumber && voice->isPlayingChannel(midiChannel) ? voice : nullptr;
+}
+
+void TwoShotVoiceAllocator::renderVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    for (int index = m_oldest; index >= 0;)
+    {
+        const int next = m_next[(size_t) index];
+        auto* voice = m_voices[(size_t) index];
+        voice->renderNextBlock(outputAudio, startSample, numSamples);
+
+        if (! voice->isVoiceActive())
+        {
+            stopPlaying(index);
+        }
+        index = next;
+    }
+}
+
+/**
+* Picks the playing voice a new note should take over, following the stealing policy
+*/
+int TwoShotVoiceAllocator::findVoiceToSteal(int midiNoteNumber) const noexcept
+{
+    switch (m_stealing)
+    {
+        case Stealing::sameNote:
+            if (isPositiveAndBelow(midiNoteNumber, (int) m_voiceForNote.size()))
+            {
+                const int index = m_voiceForNote[(size_t) midiNoteNumber];
+                if (index >= 0 && m_isPlaying[(size_t) index]
+                    && m_voices[(size_t) index]->getCurrentlyPlayingNote() == midiNoteNumber)
+                {
+                    return index;
+                }
+            }
+            break;
+
+        case Stealing::quietest:
+        {
+            int quietest = m_oldest;
+            for (int index = m_oldest; index >= 0; index = m_next[(size_t) index])
+            {
+                if (m_voices[(size_t) index]->getLevel() < m_voices[(size_t) quietest]->getLevel())
+                {
+                    quietest = index;
+                }
+            }
+            return quietest;
+        }
+
+        case Stealing::oldest:
+            break;
+    }
+    return m_oldest;
+}
+
+void TwoShotVoiceAllocator::startPlaying(int index) noexcept
+{
+    m_isPlaying[(size_t) index] = true;
+    m_previous[(size_t) index] = m_newest;
+    m_next[(size_t) index] = -1;
+
+    if (m_newest >= 0)
+    {
+        m_next[(size_t) m_newest] = index;
+    }
+    else
+    {
+        m_oldest = index;
+    }
+    m_newest = index;
+    ++m_numPlaying;
+}
+
+/**
+* Puts a voice that has finished back onto the free stack, unless it is past the polyphony limit
+*/
+void TwoShotVoiceAllocator::stopPlaying(int index) noexcept
+{
+    unlink(index);
+    if (index < m_polyphony)
+    {
+        m_free[(size_t) m_numFree++] = index;
+    }
+}
+
+void TwoShotVoiceAllocator::unlink(int index) noexcept
+{
+    const int previous = m_previous[(size_t) index];
+    const int next = m_next[(size_t) index];
+
+    if (previous >= 0)
+    {
+        m_next[(size_t) previous] = next;
+    }
+    else
+    {
+        m_oldest = next;
+    }
+
+    if (next >= 0)
+    {
+        m_previous[(size_t) next] = previous;
+    }
+    else
+    {
+        m_newest = previous;
+    }
+
+    m_isPlaying[(size_t) index] = false;
+    --m_numPlaying;
+}
+
+void TwoShotVoiceAllocator::freeFinishedVoices() noexcept
+{
+    for (int index = m_oldest; index >= 0;)
+    {
+        const int next = m_next[(size_t) index];
+        if (! m_voices[(size_t) index]->isVoiceActive())
+        {
+            stopPlaying(index);
+        }
+        index = next;
+    }
+}
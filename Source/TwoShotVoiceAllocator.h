@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    TwoShotVoiceAllocator.h
+    Created: 17 Oct 2026 8:52:17pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TwoShotVoice.h"
+
+/**
+ * Hands out voices for new notes without searching for them.
+ *
+ * Free voices sit on a stack, and playing ones on a list in the order they started,
+ * so finding a free voice, or the oldest one to steal, takes the same time however many
+ * voices there are. Only stealing the quietest voice looks at every playing voice.
+ *
+ * Everything is allocated up front for maxNumVoices. None of the methods are thread safe,
+ * they must be called with the synthesiser's lock held.
+ */
+class TwoShotVoiceAllocator
+{
+    public:
+        /** Which playing voice a new note takes over when every voice is busy */
+        enum class Stealing
+        {
+            oldest,
+            quietest,
+            /** the voice already playing the same note, or else the oldest */
+            sameNote
+        };
+
+        TwoShotVoiceAllocator();
+
+        /** Adds a voice to hand out. Voices are never removed, only left unused by setPolyphony() */
+        void addVoice(TwoShotVoice* voice);
+
+        /** Returns how many voices have been added */
+        int getNumVoices() const noexcept { return m_numVoices; }
+
+        /** Returns how many voices are playing a note, including ones still releasing */
+        int getNumPlaying() const noexcept { return m_numPlaying; }
+
+        /** Returns one of the voices that have been added */
+        TwoShotVoice* getVoice(int index) const noexcept { return m_voices[(size_t) index]; }
+
+        /** Limits how many of the voices are handed out. Voices past the limit finish their notes first */
+        void setPolyphony(int numVoices);
+
+        void setStealing(Stealing newStealing) noexcept { m_stealing = newStealing; }
+
+        /**
+         * Returns a voice to play a new note on: a free one, or if there are none and
+         * canSteal is true, one taken from another note. Returns nullptr otherwise.
+         */
+        TwoShotVoice* allocate(int midiNoteNumber, bool canSteal);
+
+        /** Returns the voice most recently given this note, if it is still playing it on this channel */
+        TwoShotVoice* findVoicePlaying(int midiNoteNumber, int midiChannel) const noexcept;
+
+        /** Renders every playing voice, and frees those that have finished */
+        void renderVoices(AudioBuffer<float>& outputAudio, int startSample, int numSamples);
+
+        /** Frees the voices that have finished, after they were rendered somewhere else */
+        void freeFinishedVoices() noexcept;
+
+        /** Calls function on every voice that is playing */
+        template <typename Function>
+        void forEachPlayingVoice(Function&& function) const
+        {
+            for (int index = m_oldest; index >= 0; index = m_next[(size_t) index])
+            {
+                function(*m_voices[(size_t) index]);
+            }
+        }
+
+        static constexpr int maxNumVoices = 256;
+
+    private:
+        int findVoiceToSteal(int midiNoteNumber) const noexcept;
+        void startPlaying(int index) noexcept;
+        void stopPlaying(int index) noexcept;
+        void unlink(int index) noexcept;
+
+        std::array<TwoShotVoice*, maxNumVoices> m_voices {};
+        int m_numVoices = 0;
+        int m_polyphony = 0;
+        Stealing m_stealing = Stealing::oldest;
+
+        // the voices that can be handed out straight away
+        std::array<int, maxNumVoices> m_free {};
+        int m_numFree = 0;
+
+        // the playing voices, linked oldest to newest
+        std::array<int, maxNumVoices> m_previous {};
+        std::array<int, maxNumVoices> m_next {};
+        std::array<bool, maxNumVoices> m_isPlaying {};
+        int m_oldest = -1;
+        int m_newest = -1;
+        int m_numPlaying = 0;
+
+        // the voice each note was last given, which may have moved on since
+        std::array<int, 128> m_voiceForNote {};
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TwoShotVoiceAllocator)
+};
@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    TwoShotVoiceParameters.h
+    Created: 17 Oct 2026 8:05:31pm
+    Author:  Deuel Lab
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TwoShotRenderKernels.h"
+
+/**
+ * The settings every voice shares, gathered in one place.
+ *
+ * The synth rebuilds this on the audio thread at the start of a block, and only when
+ * the host tempo or one of the UI settings has changed. The voices hold a reference to
+ * it, so changing a setting never has to walk the voices, and nothing in it changes
+ * while they render.
+ */
+struct TwoShotVoiceParameters
+{
+    /** How much faster the host plays than the loop was recorded, in LOOP MODE */
+    double bpmCompRatio = 1.0;
+
+    /** The repitching from the detune control, in SAMPLE MODE */
+    double detuneRatio = 1.0;
+
+    bool isLoop = false;
+
+    /** Whether notes started from now on play their sound backwards. Notes already playing keep their direction */
+    bool isReversed = false;
+
+    /** Until the attack and release are set, notes fade in and out over 10ms */
+    juce::ADSR::Parameters envelope { 0.01f, 0.1f, 1.0f, 0.01f };
+
+    TwoShotRenderKernels::Interpolation interpolation = TwoShotRenderKernels::Interpolation::linear;
+};
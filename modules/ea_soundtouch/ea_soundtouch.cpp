@@ -10,6 +10,7 @@
 
 #include "source/SoundTouch/AAFilter.cpp"
 #undef PI
+#include "source/SoundTouch/avx_optimized.cpp"
 #include "source/SoundTouch/cpu_detect_x86.cpp"
 #include "source/SoundTouch/FIRFilter.cpp"
 #include "source/SoundTouch/InterpolateCubic.cpp"
@@ -23,5 +23,6 @@ BEGIN_JUCE_MODULE_DECLARATION
 
 #include "include/SoundTouch.h"
 #include "include/BPMDetect.h"
+#include "source/SoundTouch/TDStretch.h"
 
 #include "warnings/WarningsEnd.h"
\ No newline at end of file
@@ -119,6 +119,9 @@ namespace soundtouch
         float *hamw;
         float *hamw2;
 
+        /// Correlation sums of the latest update, one for each lag
+        float *corrbuff;
+
         // beat detection variables
         int pos;
         int peakPos;
@@ -137,6 +140,15 @@ namespace soundtouch
         // 2nd order low-pass-filter
         IIR2_filter beat_lpf;
 
+        /// Correlates 'length' windowed samples against the sample history at every lag from
+        /// 'windowStart' to 'windowLen', writing the sum for each lag to 'corr[lag]'.
+        /// This is where nearly all of the analysis time goes, so it has SIMD versions.
+        virtual void calcCorrelation(float *corr,                         ///< Receives the sums
+            const soundtouch::SAMPLETYPE *weighted,  ///< Windowed samples, 'length' of them
+            const soundtouch::SAMPLETYPE *history,   ///< History, 'windowLen + length' samples
+            int length                               ///< Number of windowed samples
+        );
+
         /// Updates auto-correlation function for given number of decimated samples that
         /// are read from the internal 'buffer' pipe (samples aren't removed from the pipe
         /// though).
@@ -173,6 +185,10 @@ namespace soundtouch
         /// Destructor.
         virtual ~BPMDetect();
 
+        /// Creates a detector using the fastest routines the CPU supports.
+        /// The plain constructor always uses the C++ versions.
+        static BPMDetect *newInstance(int numChannels, int sampleRate);
+
         /// Inputs a block of samples for analyzing: Envelopes the samples and then
         /// updates the autocorrelation estimation. When whole song data has been input
         /// in smaller blocks using this function, read the resulting bpm with 'getBpm'
@@ -201,5 +217,19 @@ namespace soundtouch
         /// \return number of beats in the arrays.
         int getBeats(float *pos, float *strength, int max_num);
     };
+
+
+#ifdef SOUNDTOUCH_ALLOW_SSE
+    /// Class that implements SSE optimized routines for floating point samples type.
+    class BPMDetectSSE : public BPMDetect
+    {
+    protected:
+        void calcCorrelation(float *corr, const float *weighted, const float *history, int length);
+
+    public:
+        BPMDetectSSE(int numChannels, int sampleRate);
+    };
+
+#endif /// SOUNDTOUCH_ALLOW_SSE
 }
 #endif // _BPMDetect_H_
@@ -9,6 +9,10 @@
 /// output samples from the buffer as well as grows the storage size
 /// whenever necessary.
 ///
+/// For real-time use the buffer can instead be given a fixed capacity in
+/// memory the caller provides, with 'useArena'. It then never allocates, and
+/// works as a ring buffer so that no samples are moved as others are removed.
+///
 /// Author        : Copyright (c) Olli Parviainen
 /// Author e-mail : oparviai 'at' iki.fi
 /// SoundTouch WWW: http://www.surina.net/soundtouch
@@ -49,6 +53,11 @@ namespace soundtouch
 ///
 /// Notice that in case of stereo audio, one sample is considered to consist of
 /// both channel data.
+///
+/// With a fixed capacity, the arena holds the ring twice over: every sample written
+/// is also written one ring length further on. So however the samples wrap around
+/// the ring, 'ptrBegin' and 'ptrEnd' still point at contiguous memory, at the cost
+/// of writing each sample twice rather than moving the unread ones on each write.
 class FIFOSampleBuffer : public FIFOSamplePipe
 {
 private:
@@ -73,10 +82,22 @@ private:
     /// only new data when is put to the pipe.
     uint bufferPos;
 
+    /// Capacity of the ring in SAMPLETYPE values, when using an arena, else zero.
+    uint ringSize;
+
+    /// Position of the first unread value in the ring, when using an arena.
+    uint ringPos;
+
+    /// How many samples have been dropped for want of room in the ring.
+    uint numDropped;
+
     /// Rewind the buffer by moving data from position pointed by 'bufferPos' to real
     /// beginning of the buffer.
     void rewind();
 
+    /// Copies 'numValues' values written to the ring from 'start' to their other copy.
+    void mirror(uint start, uint numValues);
+
     /// Ensures that the buffer has capacity for at least this many samples.
     void ensureCapacity(uint capacityRequirement);
 
@@ -93,6 +114,25 @@ public:
     /// destructor
     ~FIFOSampleBuffer();
 
+    /// Returns how many SAMPLETYPE values of arena 'useArena' needs to hold 'maxSamples'
+    /// samples of 'numChannels' channels.
+    static uint getArenaSize(uint maxSamples, int numChannels);
+
+    /// Gives the buffer a fixed capacity of 'maxSamples' samples, held in 'arena', and
+    /// moves any samples already in the buffer there. From then on the buffer never
+    /// allocates memory or moves samples. Needing more than 'maxSamples' (buffered
+    /// samples plus those about to be written) is an error, which drops the oldest
+    /// samples to make room rather than throwing, and is counted by 'getNumDropped'.
+    /// No more than 'maxSamples' may be written at once. The caller owns the arena,
+    /// which must be 'getArenaSize' values long and outlive the buffer.
+    void useArena(SAMPLETYPE *arena, uint maxSamples);
+
+    /// Returns how many samples have been dropped since 'useArena' for want of room.
+    uint getNumDropped() const
+    {
+        return numDropped;
+    }
+
     /// Returns a pointer to the beginning of the output samples.
     /// This function is provided for accessing the output samples directly.
     /// Please be careful for not to corrupt the book-keeping!
@@ -123,6 +163,12 @@ public:
                             uint numSamples                         ///< Number of samples to insert.
                             );
 
+    /// Adds 'numSamples' pcs of samples given as a separate array per channel,
+    /// interleaving them straight into the buffer.
+    virtual void putPlanarSamples(const SAMPLETYPE *const *channelData,  ///< Pointer to each channel's samples.
+                                  uint numSamples                        ///< Number of samples to insert.
+                                  );
+
     /// Adjusts the book-keeping to increase number of samples in the buffer without
     /// copying any actual samples.
     ///
@@ -149,6 +195,14 @@ public:
     virtual uint receiveSamples(uint maxSamples   ///< Remove this many samples from the beginning of pipe.
                                 );
 
+    /// Output samples from beginning of the sample buffer like 'receiveSamples', but
+    /// split out of the buffer straight into a separate array per channel.
+    ///
+    /// \return Number of samples returned.
+    virtual uint receivePlanarSamples(SAMPLETYPE *const *channelData, ///< Where to copy each channel's samples.
+                                      uint maxSamples                 ///< How many samples to receive at max.
+                                      );
+
     /// Returns number of samples currently available.
     virtual uint numSamples() const;
 
@@ -84,6 +84,13 @@ public:
                             ) = 0;
 
 
+    /// Adds 'numSamples' pcs of samples given as a separate array per channel, as
+    /// hosts and audio frameworks usually keep them, to the sample buffer. The
+    /// channels are interleaved straight into the buffer, with no copy in between.
+    virtual void putPlanarSamples(const SAMPLETYPE *const *channelData,  ///< Pointer to each channel's samples.
+                                  uint numSamples                        ///< Number of samples to insert.
+                                  ) = 0;
+
     // Moves samples from the 'other' pipe instance to this instance.
     void moveSamples(FIFOSamplePipe &other  ///< Other pipe instance where from the receive the data.
          )
@@ -111,6 +118,14 @@ public:
     virtual uint receiveSamples(uint maxSamples   ///< Remove this many samples from the beginning of pipe.
                                 ) = 0;
 
+    /// Output samples from beginning of the sample buffer like 'receiveSamples', but
+    /// split out into a separate array per channel.
+    ///
+    /// \return Number of samples returned.
+    virtual uint receivePlanarSamples(SAMPLETYPE *const *channelData, ///< Where to copy each channel's samples.
+                                      uint maxSamples                 ///< How many samples to receive at max.
+                                      ) = 0;
+
     /// Returns number of samples currently available.
     virtual uint numSamples() const = 0;
 
@@ -205,6 +220,17 @@ public:
         return output->receiveSamples(maxSamples);
     }
 
+    /// Output samples from beginning of the sample buffer like 'receiveSamples', but
+    /// split out into a separate array per channel.
+    ///
+    /// \return Number of samples returned.
+    virtual uint receivePlanarSamples(SAMPLETYPE *const *channelData, ///< Where to copy each channel's samples.
+                                      uint maxSamples                 ///< How many samples to receive at max.
+                                      )
+    {
+        return output->receivePlanarSamples(channelData, maxSamples);
+    }
+
     /// Returns number of samples currently available.
     virtual uint numSamples() const
     {
@@ -155,6 +155,13 @@ namespace soundtouch
         #ifdef SOUNDTOUCH_ALLOW_X86_OPTIMIZATIONS
             // Allow SSE optimizations
             #define SOUNDTOUCH_ALLOW_SSE       1
+
+            // Allow AVX2 and AVX-512 optimizations in 64bit builds. They're compiled
+            // for those instruction sets function by function, and only used if
+            // detectCPUextensions finds them at run time.
+            #if (__x86_64__ || _M_X64)
+                #define SOUNDTOUCH_ALLOW_AVX   1
+            #endif
         #endif
 
     #endif  // SOUNDTOUCH_INTEGER_SAMPLES
@@ -197,6 +197,10 @@ private:
     /// 'virtualPitch' parameters.
     void calcEffectiveRateAndTempo();
 
+    /// Checks that samples can be put in, and accounts for the output 'nSamples'
+    /// more samples are expected to make.
+    void acceptInput(uint nSamples);
+
 protected :
     /// Number of channels
     uint  channels;
@@ -289,6 +293,14 @@ public:
                                                     ///< contains data for both channels.
             );
 
+    /// Adds 'numSamples' pcs of samples given as a separate array per channel into
+    /// the input of the object, interleaving them straight into the first processing
+    /// stage. Otherwise the same as 'putSamples'.
+    virtual void putPlanarSamples(
+            const SAMPLETYPE *const *channelData,   ///< Pointer to each channel's samples.
+            uint numSamples                         ///< Number of samples in each channel.
+            );
+
     /// Output samples from beginning of the sample buffer. Copies requested samples to
     /// output buffer and removes them from the sample buffer. If there are less than
     /// 'numsample' samples in the buffer, returns all that available.
@@ -306,6 +318,14 @@ public:
     virtual uint receiveSamples(uint maxSamples   ///< Remove this many samples from the beginning of pipe.
         );
 
+    /// Output samples from beginning of the sample buffer like 'receiveSamples', but
+    /// split out into a separate array per channel.
+    ///
+    /// \return Number of samples returned.
+    virtual uint receivePlanarSamples(SAMPLETYPE *const *channelData, ///< Where to copy each channel's samples.
+        uint maxSamples                 ///< How many samples to receive at max.
+        );
+
     /// Clears all the samples in the object's output and internal processing
     /// buffers.
     virtual void clear();
@@ -57,6 +57,7 @@
 #include "FIFOSampleBuffer.h"
 #include "PeakFinder.h"
 #include "BPMDetect.h"
+#include "cpu_detect.h"
 
 using namespace soundtouch;
 
@@ -206,6 +207,8 @@ BPMDetect::BPMDetect(int numChannels, int aSampleRate) :
     beatcorr_ringbuffpos = 0;
     beatcorr_ringbuff = new float[windowLen];
     memset(beatcorr_ringbuff, 0, windowLen * sizeof(float));
+    corrbuff = new float[windowLen];
+    memset(corrbuff, 0, windowLen * sizeof(float));
 
     // allocate processing buffer
     buffer = new FIFOSampleBuffer();
@@ -225,12 +228,28 @@ BPMDetect::~BPMDetect()
 {
     delete[] xcorr;
     delete[] beatcorr_ringbuff;
+    delete[] corrbuff;
     delete[] hamw;
     delete[] hamw2;
     delete buffer;
 }
 
 
+BPMDetect * BPMDetect::newInstance(int numChannels, int sampleRate)
+{
+#ifdef SOUNDTOUCH_ALLOW_SSE
+    if (detectCPUextensions() & SUPPORT_SSE)
+    {
+        // SSE support
+        return ::new BPMDetectSSE(numChannels, sampleRate);
+    }
+#endif // SOUNDTOUCH_ALLOW_SSE
+
+    // ISA optimizations not supported, use plain C version
+    return ::new BPMDetect(numChannels, sampleRate);
+}
+
+
 /// convert to mono, low-pass filter & decimate to about 500 Hz.
 /// return number of outputted samples.
 ///
@@ -250,18 +269,27 @@ int BPMDetect::decimate(SAMPLETYPE *dest, const SAMPLETYPE *src, int numsamples)
     assert(channels > 0);
     assert(decimateBy > 0);
     outcount = 0;
-    for (count = 0; count < numsamples; count ++)
+    count = 0;
+    while (count < numsamples)
     {
-        int j;
+        // convert to mono and accumulate up to the end of the current output sample,
+        // all channels in one run as they're interleaved
+        int run = decimateBy - decimateCount;
+        if (run > numsamples - count)
+        {
+            run = numsamples - count;
+        }
 
-        // convert to mono and accumulate
-        for (j = 0; j < channels; j ++)
+        LONG_SAMPLETYPE sum = 0;
+        for (int j = 0; j < run * channels; j ++)
         {
-            decimateSum += src[j];
+            sum += src[j];
         }
-        src += j;
+        decimateSum += sum;
+        src += run * channels;
+        count += run;
 
-        decimateCount ++;
+        decimateCount += run;
         if (decimateCount >= decimateBy)
         {
             // Store every Nth sample only
@@ -287,6 +315,21 @@ int BPMDetect::decimate(SAMPLETYPE *dest, const SAMPLETYPE *src, int numsamples)
 }
 
 
+// Correlates the windowed samples against the history at every lag
+void BPMDetect::calcCorrelation(float *corr, const SAMPLETYPE *weighted, const SAMPLETYPE *history, int length)
+{
+    for (int offs = windowStart; offs < windowLen; offs ++)
+    {
+        double sum = 0;
+        for (int i = 0; i < length; i ++)
+        {
+            sum += weighted[i] * history[i + offs];  // scaling the sub-result shouldn't be necessary
+        }
+        corr[offs] = (float)sum;
+    }
+}
+
+
 // Calculates autocorrelation function of the sample history buffer
 void BPMDetect::updateXCorr(int process_samples)
 {
@@ -308,20 +351,13 @@ void BPMDetect::updateXCorr(int process_samples)
         tmp[i] = hamw[i] * hamw[i] * pBuffer[i];
     }
 
-    #pragma omp parallel for
+    calcCorrelation(corrbuff, tmp, pBuffer, process_samples);
+
     for (offs = windowStart; offs < windowLen; offs ++)
     {
-        double sum;
-        int i;
-
-        sum = 0;
-        for (i = 0; i < process_samples; i ++)
-        {
-            sum += tmp[i] * pBuffer[i + offs];  // scaling the sub-result shouldn't be necessary
-        }
         xcorr[offs] *= xcorr_decay;   // decay 'xcorr' here with suitable time constant.
 
-        xcorr[offs] += (float)fabs(sum);
+        xcorr[offs] += (float)fabs(corrbuff[offs]);
     }
 }
 
@@ -348,15 +384,12 @@ void BPMDetect::updateBeatPos(int process_samples)
         tmp[i] = hamw2[i] * hamw2[i] * pBuffer[i];
     }
 
-    #pragma omp parallel for
+    calcCorrelation(corrbuff, tmp, pBuffer, process_samples);
+
     for (int offs = windowStart; offs < windowLen; offs++)
     {
-        double sum = 0;
-        for (int i = 0; i < process_samples; i++)
-        {
-            sum += tmp[i] * pBuffer[offs + i];
-        }
-        beatcorr_ringbuff[(beatcorr_ringbuffpos + offs) % windowLen] += (float)((sum > 0) ? sum : 0); // accumulate only positive correlations
+        float sum = corrbuff[offs];
+        beatcorr_ringbuff[(beatcorr_ringbuffpos + offs) % windowLen] += (sum > 0) ? sum : 0; // accumulate only positive correlations
     }
 
     int skipstep = XCORR_UPDATE_SEQUENCE / OVERLAP_FACTOR;
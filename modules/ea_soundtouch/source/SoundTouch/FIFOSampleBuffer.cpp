@@ -43,8 +43,105 @@
 
 #include "FIFOSampleBuffer.h"
 
+// SSE is part of every 64bit x86 CPU, so the channel transposes can use it
+// without asking detectCPUextensions first
+#if defined(SOUNDTOUCH_ALLOW_SSE) && (__x86_64__ || _M_X64)
+    #define ST_TRANSPOSE_SSE    1
+    #include <xmmintrin.h>
+#endif
+
 using namespace soundtouch;
 
+
+// Interleaves 'numSamples' samples of each of 'channels' channels into 'dest'.
+// Stereo, by far the most common, transposes four samples at a time.
+static void interleave(SAMPLETYPE *dest, const SAMPLETYPE *const *src, uint channels, uint numSamples)
+{
+    uint i = 0;
+
+    if (channels == 1)
+    {
+        memcpy(dest, src[0], numSamples * sizeof(SAMPLETYPE));
+        return;
+    }
+
+    if (channels == 2)
+    {
+        const SAMPLETYPE *left = src[0];
+        const SAMPLETYPE *right = src[1];
+
+#if defined(ST_TRANSPOSE_SSE)
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            __m128 vLeft = _mm_loadu_ps(left + i);
+            __m128 vRight = _mm_loadu_ps(right + i);
+            _mm_storeu_ps(dest + 2 * i, _mm_unpacklo_ps(vLeft, vRight));
+            _mm_storeu_ps(dest + 2 * i + 4, _mm_unpackhi_ps(vLeft, vRight));
+        }
+#endif
+        for (; i < numSamples; i++)
+        {
+            dest[2 * i] = left[i];
+            dest[2 * i + 1] = right[i];
+        }
+        return;
+    }
+
+    for (uint c = 0; c < channels; c++)
+    {
+        const SAMPLETYPE *channel = src[c];
+        for (i = 0; i < numSamples; i++)
+        {
+            dest[i * channels + c] = channel[i];
+        }
+    }
+}
+
+
+// Splits 'numSamples' interleaved samples of 'channels' channels out of 'src'
+// into a separate array per channel.
+static void deinterleave(SAMPLETYPE *const *dest, const SAMPLETYPE *src, uint channels, uint numSamples)
+{
+    uint i = 0;
+
+    if (channels == 1)
+    {
+        memcpy(dest[0], src, numSamples * sizeof(SAMPLETYPE));
+        return;
+    }
+
+    if (channels == 2)
+    {
+        SAMPLETYPE *left = dest[0];
+        SAMPLETYPE *right = dest[1];
+
+#if defined(ST_TRANSPOSE_SSE)
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            __m128 vFirst = _mm_loadu_ps(src + 2 * i);
+            __m128 vSecond = _mm_loadu_ps(src + 2 * i + 4);
+            _mm_storeu_ps(left + i, _mm_shuffle_ps(vFirst, vSecond, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(right + i, _mm_shuffle_ps(vFirst, vSecond, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+#endif
+        for (; i < numSamples; i++)
+        {
+            left[i] = src[2 * i];
+            right[i] = src[2 * i + 1];
+        }
+        return;
+    }
+
+    for (uint c = 0; c < channels; c++)
+    {
+        SAMPLETYPE *channel = dest[c];
+        for (i = 0; i < numSamples; i++)
+        {
+            channel[i] = src[i * channels + c];
+        }
+    }
+}
+
 // Constructor
 FIFOSampleBuffer::FIFOSampleBuffer(int numChannels)
 {
@@ -55,6 +152,9 @@ FIFOSampleBuffer::FIFOSampleBuffer(int numChannels)
     samplesInBuffer = 0;
     bufferPos = 0;
     channels = (uint)numChannels;
+    ringSize = 0;
+    ringPos = 0;
+    numDropped = 0;
     ensureCapacity(32);     // allocate initial capacity
 }
 
@@ -81,6 +181,65 @@ void FIFOSampleBuffer::setChannels(int numChannels)
 }
 
 
+// Returns how many values of arena a fixed capacity of 'maxSamples' samples needs:
+// the ring twice over, plus room to align it to a 16 byte boundary.
+uint FIFOSampleBuffer::getArenaSize(uint maxSamples, int numChannels)
+{
+    return 2 * maxSamples * (uint)numChannels + 16 / sizeof(SAMPLETYPE);
+}
+
+
+// Switches to a fixed capacity ring in the given arena, keeping the samples
+// in the buffer. Frees the memory the buffer had grown, so must not be called
+// from a real-time thread.
+void FIFOSampleBuffer::useArena(SAMPLETYPE *arena, uint maxSamples)
+{
+    uint numValues = samplesInBuffer * channels;
+    SAMPLETYPE *ring = (SAMPLETYPE *)SOUNDTOUCH_ALIGN_POINTER_16(arena);
+
+    assert(arena != NULL);
+    if (samplesInBuffer > maxSamples)
+    {
+        ST_THROW_RT_ERROR("FIFOSampleBuffer: arena is too small for the samples in the buffer");
+    }
+
+    if (numValues)
+    {
+        memcpy(ring, ptrBegin(), numValues * sizeof(SAMPLETYPE));
+    }
+    delete[] bufferUnaligned;
+    bufferUnaligned = NULL;
+
+    buffer = ring;
+    ringSize = maxSamples * channels;
+    ringPos = 0;
+    numDropped = 0;
+    bufferPos = 0;
+    sizeInBytes = ringSize * sizeof(SAMPLETYPE);
+    mirror(0, numValues);
+}
+
+
+// Copies values just written to the ring, which may span the end of its first
+// copy, to the other copy so that both stay the same.
+void FIFOSampleBuffer::mirror(uint start, uint numValues)
+{
+    assert(start < ringSize || numValues == 0);
+    assert(numValues <= ringSize);
+
+    if (start + numValues <= ringSize)
+    {
+        memcpy(buffer + ringSize + start, buffer + start, numValues * sizeof(SAMPLETYPE));
+    }
+    else
+    {
+        uint numInFirst = ringSize - start;
+        memcpy(buffer + ringSize + start, buffer + start, numInFirst * sizeof(SAMPLETYPE));
+        memcpy(buffer, buffer + ringSize, (numValues - numInFirst) * sizeof(SAMPLETYPE));
+    }
+}
+
+
 // if output location pointer 'bufferPos' isn't zero, 'rewinds' the buffer and
 // zeroes this pointer by copying samples from the 'bufferPos' pointer
 // location on to the beginning of the buffer.
@@ -99,6 +258,25 @@ void FIFOSampleBuffer::rewind()
 void FIFOSampleBuffer::putSamples(const SAMPLETYPE *samples, uint nSamples)
 {
     memcpy(ptrEnd(nSamples), samples, sizeof(SAMPLETYPE) * nSamples * channels);
+    if (ringSize)
+    {
+        putSamples(nSamples);
+        return;
+    }
+    samplesInBuffer += nSamples;
+}
+
+
+// Adds 'numSamples' pcs of samples given as a separate array per channel,
+// interleaving them straight into the end of the buffer.
+void FIFOSampleBuffer::putPlanarSamples(const SAMPLETYPE *const *channelData, uint nSamples)
+{
+    interleave(ptrEnd(nSamples), channelData, channels, nSamples);
+    if (ringSize)
+    {
+        putSamples(nSamples);
+        return;
+    }
     samplesInBuffer += nSamples;
 }
 
@@ -115,6 +293,12 @@ void FIFOSampleBuffer::putSamples(uint nSamples)
 
     req = samplesInBuffer + nSamples;
     ensureCapacity(req);
+    if (ringSize)
+    {
+        // the samples were written after the unread ones, through 'ptrEnd'
+        uint end = ringPos + samplesInBuffer * channels;
+        mirror((end >= ringSize) ? end - ringSize : end, nSamples * channels);
+    }
     samplesInBuffer += nSamples;
 }
 
@@ -134,6 +318,12 @@ void FIFOSampleBuffer::putSamples(uint nSamples)
 SAMPLETYPE *FIFOSampleBuffer::ptrEnd(uint slackCapacity)
 {
     ensureCapacity(samplesInBuffer + slackCapacity);
+    if (ringSize)
+    {
+        // the first copy of the ring position, so there's a whole ring's room after it
+        uint end = ringPos + samplesInBuffer * channels;
+        return buffer + ((end >= ringSize) ? end - ringSize : end);
+    }
     return buffer + samplesInBuffer * channels;
 }
 
@@ -148,6 +338,10 @@ SAMPLETYPE *FIFOSampleBuffer::ptrEnd(uint slackCapacity)
 SAMPLETYPE *FIFOSampleBuffer::ptrBegin()
 {
     assert(buffer);
+    if (ringSize)
+    {
+        return buffer + ringPos;
+    }
     return buffer + bufferPos * channels;
 }
 
@@ -160,6 +354,30 @@ void FIFOSampleBuffer::ensureCapacity(uint capacityRequirement)
 {
     SAMPLETYPE *tempUnaligned, *temp;
 
+    if (ringSize)
+    {
+        // a fixed capacity never grows, and a ring never needs rewinding. Running out is
+        // an error, but one the real-time thread can't be stopped by: the oldest samples
+        // are dropped to make room, and counted
+        uint capacity = getCapacity();
+        if (capacityRequirement > capacity)
+        {
+            uint numToDrop = capacityRequirement - capacity;
+
+            // whatever is to be written must fit the ring, or it would run off the arena
+            assert(numToDrop <= samplesInBuffer);
+            if (numToDrop > samplesInBuffer) numToDrop = samplesInBuffer;
+
+            // not through receiveSamples, which starts an emptied ring again from the
+            // beginning, as the new samples may already be written after the old ones
+            samplesInBuffer -= numToDrop;
+            ringPos += numToDrop * channels;
+            if (ringPos >= ringSize) ringPos -= ringSize;
+            numDropped += numToDrop;
+        }
+        return;
+    }
+
     if (capacityRequirement > getCapacity())
     {
         // enlarge the buffer in 4kbyte steps (round up to next 4k boundary)
@@ -192,6 +410,10 @@ void FIFOSampleBuffer::ensureCapacity(uint capacityRequirement)
 // Returns the current buffer capacity in terms of samples
 uint FIFOSampleBuffer::getCapacity() const
 {
+    if (ringSize)
+    {
+        return ringSize / channels;
+    }
     return sizeInBytes / (channels * sizeof(SAMPLETYPE));
 }
 
@@ -219,6 +441,21 @@ uint FIFOSampleBuffer::receiveSamples(SAMPLETYPE *output, uint maxSamples)
 }
 
 
+// Output samples from beginning of the sample buffer like 'receiveSamples',
+// but split out into a separate array per channel.
+//
+// Returns number of samples copied.
+uint FIFOSampleBuffer::receivePlanarSamples(SAMPLETYPE *const *channelData, uint maxSamples)
+{
+    uint num;
+
+    num = (maxSamples > samplesInBuffer) ? samplesInBuffer : maxSamples;
+
+    deinterleave(channelData, ptrBegin(), channels, num);
+    return receiveSamples(num);
+}
+
+
 // Removes samples from the beginning of the sample buffer without copying them
 // anywhere. Used to reduce the number of samples in the buffer, when accessing
 // the sample buffer with the 'ptrBegin' function.
@@ -230,10 +467,18 @@ uint FIFOSampleBuffer::receiveSamples(uint maxSamples)
 
         temp = samplesInBuffer;
         samplesInBuffer = 0;
+        // empty, so the ring can start again from the beginning
+        ringPos = 0;
         return temp;
     }
 
     samplesInBuffer -= maxSamples;
+    if (ringSize)
+    {
+        ringPos += maxSamples * channels;
+        if (ringPos >= ringSize) ringPos -= ringSize;
+        return maxSamples;
+    }
     bufferPos += maxSamples;
 
     return maxSamples;
@@ -252,6 +497,7 @@ void FIFOSampleBuffer::clear()
 {
     samplesInBuffer = 0;
     bufferPos = 0;
+    ringPos = 0;
 }
 
 
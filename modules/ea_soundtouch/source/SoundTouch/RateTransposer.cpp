@@ -119,22 +119,31 @@ void RateTransposer::setRate(double newRate)
 // the input of the object.
 void RateTransposer::putSamples(const SAMPLETYPE *samples, uint nSamples)
 {
-    processSamples(samples, nSamples);
+    if (nSamples == 0) return;
+
+    // Store samples to input buffer
+    inputBuffer.putSamples(samples, nSamples);
+    processSamples();
 }
 
 
-// Transposes sample rate by applying anti-alias filter to prevent folding.
-// Returns amount of samples returned in the "dest" buffer.
-// The maximum amount of samples that can be returned at a time is set by
-// the 'set_returnBuffer_size' function.
-void RateTransposer::processSamples(const SAMPLETYPE *src, uint nSamples)
+// Adds 'nSamples' pcs of samples given as a separate array per channel into
+// the input of the object.
+void RateTransposer::putPlanarSamples(const SAMPLETYPE *const *channelData, uint nSamples)
 {
-    uint count;
-
     if (nSamples == 0) return;
 
-    // Store samples to input buffer
-    inputBuffer.putSamples(src, nSamples);
+    // Interleave samples to input buffer
+    inputBuffer.putPlanarSamples(channelData, nSamples);
+    processSamples();
+}
+
+
+// Transposes sample rate of the samples in the input buffer by applying
+// anti-alias filter to prevent folding, and stores them in the output buffer.
+void RateTransposer::processSamples()
+{
+    uint count;
 
     // If anti-alias filter is turned off, simply transpose without applying
     // the filter
@@ -114,12 +114,9 @@ protected:
     bool bUseAAFilter;
 
 
-    /// Transposes sample rate by applying anti-alias filter to prevent folding.
-    /// Returns amount of samples returned in the "dest" buffer.
-    /// The maximum amount of samples that can be returned at a time is set by
-    /// the 'set_returnBuffer_size' function.
-    void processSamples(const SAMPLETYPE *src,
-                        uint numSamples);
+    /// Transposes the samples in the input buffer, applying anti-alias filter to
+    /// prevent folding, into the output buffer.
+    void processSamples();
 
 public:
     RateTransposer();
@@ -148,6 +145,10 @@ public:
     /// the input of the object.
     void putSamples(const SAMPLETYPE *samples, uint numSamples);
 
+    /// Adds 'numSamples' pcs of samples given as a separate array per channel into
+    /// the input of the object.
+    void putPlanarSamples(const SAMPLETYPE *const *channelData, uint numSamples);
+
     /// Clears all the samples in the object
     void clear();
 
@@ -276,25 +276,39 @@ void SoundTouch::setSampleRate(uint srate)
 // the input of the object.
 void SoundTouch::putSamples(const SAMPLETYPE *samples, uint nSamples)
 {
-    if (bSrateSet == false)
+    acceptInput(nSamples);
+
+#ifndef SOUNDTOUCH_PREVENT_CLICK_AT_RATE_CROSSOVER
+    if (rate <= 1.0f)
     {
-        ST_THROW_RT_ERROR("SoundTouch : Sample rate not defined");
+        // transpose the rate down, output the transposed sound to tempo changer buffer
+        assert(output == pTDStretch);
+        pRateTransposer->putSamples(samples, nSamples);
+        pTDStretch->moveSamples(*pRateTransposer);
     }
-    else if (channels == 0)
+    else
+#endif
     {
-        ST_THROW_RT_ERROR("SoundTouch : Number of channels not defined");
+        // evaluate the tempo changer, then transpose the rate up,
+        assert(output == pRateTransposer);
+        pTDStretch->putSamples(samples, nSamples);
+        pRateTransposer->moveSamples(*pTDStretch);
     }
+}
 
-    // accumulate how many samples are expected out from processing, given the current
-    // processing setting
-    samplesExpectedOut += (double)nSamples / ((double)rate * (double)tempo);
+
+// Adds 'numSamples' pcs of samples given as a separate array per channel into
+// the input of the object.
+void SoundTouch::putPlanarSamples(const SAMPLETYPE *const *channelData, uint nSamples)
+{
+    acceptInput(nSamples);
 
 #ifndef SOUNDTOUCH_PREVENT_CLICK_AT_RATE_CROSSOVER
     if (rate <= 1.0f)
     {
         // transpose the rate down, output the transposed sound to tempo changer buffer
         assert(output == pTDStretch);
-        pRateTransposer->putSamples(samples, nSamples);
+        pRateTransposer->putPlanarSamples(channelData, nSamples);
         pTDStretch->moveSamples(*pRateTransposer);
     }
     else
@@ -302,12 +316,31 @@ void SoundTouch::putSamples(const SAMPLETYPE *samples, uint nSamples)
     {
         // evaluate the tempo changer, then transpose the rate up,
         assert(output == pRateTransposer);
-        pTDStretch->putSamples(samples, nSamples);
+        pTDStretch->putPlanarSamples(channelData, nSamples);
         pRateTransposer->moveSamples(*pTDStretch);
     }
 }
 
 
+// Checks that samples can be put in, and accounts for the output they're
+// expected to make.
+void SoundTouch::acceptInput(uint nSamples)
+{
+    if (bSrateSet == false)
+    {
+        ST_THROW_RT_ERROR("SoundTouch : Sample rate not defined");
+    }
+    else if (channels == 0)
+    {
+        ST_THROW_RT_ERROR("SoundTouch : Number of channels not defined");
+    }
+
+    // accumulate how many samples are expected out from processing, given the current
+    // processing setting
+    samplesExpectedOut += (double)nSamples / ((double)rate * (double)tempo);
+}
+
+
 // Flushes the last samples from the processing pipeline to the output.
 // Clears also the internal processing buffers.
 //
@@ -529,6 +562,18 @@ uint SoundTouch::receiveSamples(uint maxSamples)
 }
 
 
+/// Output samples from beginning of the sample buffer like 'receiveSamples', but
+/// split out into a separate array per channel.
+///
+/// \return Number of samples returned.
+uint SoundTouch::receivePlanarSamples(SAMPLETYPE *const *channelData, uint maxSamples)
+{
+    uint ret = FIFOProcessor::receivePlanarSamples(channelData, maxSamples);
+    samplesOutput += (long)ret;
+    return ret;
+}
+
+
 /// Get ratio between input and output audio durations, useful for calculating
 /// processed output duration: if you'll process a stream of N samples, then
 /// you can expect to get out N * getInputOutputSampleRatio() samples.
@@ -735,6 +735,17 @@ void TDStretch::putSamples(const SAMPLETYPE *samples, uint nSamples)
 }
 
 
+// Adds 'numsamples' pcs of samples given as a separate array per channel into
+// the input of the object.
+void TDStretch::putPlanarSamples(const SAMPLETYPE *const *channelData, uint nSamples)
+{
+    // Interleave the samples into the input buffer
+    inputBuffer.putPlanarSamples(channelData, nSamples);
+    // Process the samples in input buffer
+    processSamples();
+}
+
+
 
 /// Set new overlap length parameter & reallocate RefMidBuffer if necessary.
 void TDStretch::acceptNewOverlapLength(int newOverlapLength)
@@ -786,6 +797,21 @@ TDStretch * TDStretch::newInstance()
 #endif // SOUNDTOUCH_ALLOW_MMX
 
 
+#ifdef SOUNDTOUCH_ALLOW_AVX
+    if (uExtensions & SUPPORT_AVX512)
+    {
+        // AVX-512 support
+        return ::new TDStretchAVX512;
+    }
+    else if (uExtensions & SUPPORT_AVX2)
+    {
+        // AVX2 & FMA support
+        return ::new TDStretchAVX2;
+    }
+    else
+#endif // SOUNDTOUCH_ALLOW_AVX
+
+
 #ifdef SOUNDTOUCH_ALLOW_SSE
     if (uExtensions & SUPPORT_SSE)
     {
@@ -229,6 +229,13 @@ public:
                                                     ///< contains both channels if stereo
             );
 
+    /// Adds 'numsamples' pcs of samples given as a separate array per channel into
+    /// the input of the object.
+    virtual void putPlanarSamples(
+            const SAMPLETYPE *const *channelData,   ///< Input sample data of each channel
+            uint numSamples                         ///< Number of samples in each channel
+            );
+
     /// return nominal input sample requirement for triggering a processing batch
     int getInputSampleReq() const
     {
@@ -275,5 +282,29 @@ public:
 
 #endif /// SOUNDTOUCH_ALLOW_SSE
 
+
+#ifdef SOUNDTOUCH_ALLOW_AVX
+    /// Class that implements AVX2 & FMA optimized routines for floating point samples type.
+    class TDStretchAVX2 : public TDStretch
+    {
+    protected:
+        double calcCrossCorr(const float *mixingPos, const float *compare, double &norm);
+        double calcCrossCorrAccumulate(const float *mixingPos, const float *compare, double &norm);
+        virtual void overlapStereo(float *output, const float *input) const;
+        virtual void overlapMono(float *output, const float *input) const;
+        virtual void overlapMulti(float *output, const float *input) const;
+    };
+
+    /// Class that implements AVX-512 optimized routines for floating point samples type.
+    /// Overlapping runs only once per sequence, so that uses the AVX2 routines.
+    class TDStretchAVX512 : public TDStretchAVX2
+    {
+    protected:
+        double calcCrossCorr(const float *mixingPos, const float *compare, double &norm);
+    };
+
+#endif /// SOUNDTOUCH_ALLOW_AVX
+
+
 }
 #endif  /// TDStretch_H
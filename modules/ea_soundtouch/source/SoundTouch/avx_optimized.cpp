@@ -0,0 +1,269 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// AVX2 and AVX-512 optimized routines for Haswell, Zen and later CPUs, and for
+/// Skylake-X and later CPUs. All AVX optimized functions have been gathered into
+/// this single source code file, the same way as the SSE ones are.
+///
+/// The library is built for plain x86-64, so each routine here is compiled for
+/// its own instruction set with a target attribute on GCC and Clang (Visual C++
+/// allows the intrinsics anywhere). They mustn't be called unless
+/// detectCPUextensions has reported SUPPORT_AVX2 or SUPPORT_AVX512, which
+/// TDStretch::newInstance takes care of.
+///
+/// The results differ from those of the SSE routines only in rounding, as the
+/// sums are added up in a different order and with fused multiply-adds.
+///
+/// SoundTouch WWW: http://www.surina.net/soundtouch
+///
+////////////////////////////////////////////////////////////////////////////////
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "cpu_detect.h"
+#include "STTypes.h"
+
+using namespace soundtouch;
+
+#ifdef SOUNDTOUCH_ALLOW_AVX
+
+// AVX routines available only with float sample type, in 64bit builds
+
+#include "TDStretch.h"
+#include <immintrin.h>
+#include <math.h>
+
+#if defined(__GNUC__)
+    #define ST_TARGET_AVX2      __attribute__((target("avx2,fma")))
+    #define ST_TARGET_AVX512    __attribute__((target("avx512f,avx2,fma")))
+#else
+    #define ST_TARGET_AVX2
+    #define ST_TARGET_AVX512
+#endif
+
+
+// Adds up the lanes in the same order as the SSE routines do
+ST_TARGET_AVX2 static inline float sumLanesAVX(__m256 v)
+{
+    __m128 vSum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    float *pvSum = (float*)&vSum;
+    return pvSum[0] + pvSum[1] + pvSum[2] + pvSum[3];
+}
+
+
+// Adds up the lanes of a 512 bit vector, by adding its upper half onto its lower half first.
+// Goes through memory, as GCC warns about the shuffle intrinsics.
+ST_TARGET_AVX512 static inline float sumLanesAVX512(__m512 v)
+{
+    float lanes[16];
+    _mm512_storeu_ps(lanes, v);
+    return sumLanesAVX(_mm256_add_ps(_mm256_loadu_ps(lanes), _mm256_loadu_ps(lanes + 8)));
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// implementation of AVX2 optimized functions of class 'TDStretchAVX2'
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Calculates cross correlation of two buffers
+ST_TARGET_AVX2
+double TDStretchAVX2::calcCrossCorr(const float *pV1, const float *pV2, double &anorm)
+{
+    int i;
+    __m256 vSum0, vSum1, vNorm0, vNorm1;
+
+#ifdef SOUNDTOUCH_ALLOW_NONEXACT_SIMD_OPTIMIZATION
+    // Skip the same unaligned locations as the SSE routine, so that both
+    // look for the best overlap among the same positions. The loads below
+    // tolerate any alignment.
+    if (((ulongptr)pV1) & 15) return -1e50;
+#endif
+
+    // ensure overlapLength is divisible by 8
+    assert((overlapLength % 8) == 0);
+
+    vSum0 = vSum1 = vNorm0 = vNorm1 = _mm256_setzero_ps();
+
+    // 16 samples a round, with two sets of sums to keep both FMA units busy.
+    // Same routine for stereo & mono, like the SSE version.
+    for (i = 0; i < channels * overlapLength / 16; i ++)
+    {
+        __m256 vTemp0 = _mm256_loadu_ps(pV1);
+        __m256 vTemp1 = _mm256_loadu_ps(pV1 + 8);
+
+        vSum0  = _mm256_fmadd_ps(vTemp0, _mm256_loadu_ps(pV2), vSum0);
+        vSum1  = _mm256_fmadd_ps(vTemp1, _mm256_loadu_ps(pV2 + 8), vSum1);
+        vNorm0 = _mm256_fmadd_ps(vTemp0, vTemp0, vNorm0);
+        vNorm1 = _mm256_fmadd_ps(vTemp1, vTemp1, vNorm1);
+
+        pV1 += 16;
+        pV2 += 16;
+    }
+
+    float norm = sumLanesAVX(_mm256_add_ps(vNorm0, vNorm1));
+    anorm = norm;
+
+    return (double)sumLanesAVX(_mm256_add_ps(vSum0, vSum1)) / sqrt(norm < 1e-9 ? 1.0 : norm);
+}
+
+
+double TDStretchAVX2::calcCrossCorrAccumulate(const float *pV1, const float *pV2, double &norm)
+{
+    // call usual calcCrossCorr function for the same reasons as the SSE version does
+    return calcCrossCorr(pV1, pV2, norm);
+}
+
+
+// Overlaps samples in 'midBuffer' with the samples in 'pInput', 4 stereo samples at a time
+ST_TARGET_AVX2
+void TDStretchAVX2::overlapStereo(float *pOutput, const float *pInput) const
+{
+    int i;
+    const float fScale = 1.0f / (float)overlapLength;
+
+    // weights of the input for this round's 4 samples, both channels of each
+    __m256 vF1 = _mm256_mul_ps(_mm256_setr_ps(0, 0, 1, 1, 2, 2, 3, 3), _mm256_set1_ps(fScale));
+    const __m256 vStep = _mm256_set1_ps(4 * fScale);
+    const __m256 vOne = _mm256_set1_ps(1.0f);
+
+    for (i = 0; i < 2 * overlapLength; i += 8)
+    {
+        __m256 vF2 = _mm256_sub_ps(vOne, vF1);
+        __m256 vOut = _mm256_mul_ps(_mm256_loadu_ps(pMidBuffer + i), vF2);
+        vOut = _mm256_fmadd_ps(_mm256_loadu_ps(pInput + i), vF1, vOut);
+        _mm256_storeu_ps(pOutput + i, vOut);
+
+        vF1 = _mm256_add_ps(vF1, vStep);
+    }
+}
+
+
+// Overlaps samples in 'midBuffer' with the samples in 'pInput', 8 samples at a time
+ST_TARGET_AVX2
+void TDStretchAVX2::overlapMono(float *pOutput, const float *pInput) const
+{
+    int i;
+    __m256 vM1 = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 vLength = _mm256_set1_ps((float)overlapLength);
+    const __m256 vStep = _mm256_set1_ps(8);
+
+    // overlapLength is divisible by 8
+    for (i = 0; i < overlapLength; i += 8)
+    {
+        __m256 vM2 = _mm256_sub_ps(vLength, vM1);
+        __m256 vOut = _mm256_mul_ps(_mm256_loadu_ps(pMidBuffer + i), vM2);
+        vOut = _mm256_fmadd_ps(_mm256_loadu_ps(pInput + i), vM1, vOut);
+        _mm256_storeu_ps(pOutput + i, _mm256_div_ps(vOut, vLength));
+
+        vM1 = _mm256_add_ps(vM1, vStep);
+    }
+}
+
+
+// Overlaps samples in 'midBuffer' with the samples in 'pInput', 8 channels of a sample at a time
+ST_TARGET_AVX2
+void TDStretchAVX2::overlapMulti(float *pOutput, const float *pInput) const
+{
+    const float fScale = 1.0f / (float)overlapLength;
+    float f1 = 0;
+    float f2 = 1.0f;
+    int i = 0;
+
+    for (int i2 = 0; i2 < overlapLength; i2 ++)
+    {
+        const __m256 vF1 = _mm256_set1_ps(f1);
+        const __m256 vF2 = _mm256_set1_ps(f2);
+        int c = 0;
+
+        for (; c + 8 <= channels; c += 8)
+        {
+            __m256 vOut = _mm256_mul_ps(_mm256_loadu_ps(pMidBuffer + i + c), vF2);
+            vOut = _mm256_fmadd_ps(_mm256_loadu_ps(pInput + i + c), vF1, vOut);
+            _mm256_storeu_ps(pOutput + i + c, vOut);
+        }
+        for (; c < channels; c ++)
+        {
+            pOutput[i + c] = pInput[i + c] * f1 + pMidBuffer[i + c] * f2;
+        }
+
+        i += channels;
+        f1 += fScale;
+        f2 -= fScale;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// implementation of AVX-512 optimized functions of class 'TDStretchAVX512'
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Calculates cross correlation of two buffers
+ST_TARGET_AVX512
+double TDStretchAVX512::calcCrossCorr(const float *pV1, const float *pV2, double &anorm)
+{
+    int i;
+    __m512 vSum0, vSum1, vNorm0, vNorm1;
+
+#ifdef SOUNDTOUCH_ALLOW_NONEXACT_SIMD_OPTIMIZATION
+    // skip the same unaligned locations as the SSE routine
+    if (((ulongptr)pV1) & 15) return -1e50;
+#endif
+
+    // ensure overlapLength is divisible by 8
+    assert((overlapLength % 8) == 0);
+
+    vSum0 = vSum1 = vNorm0 = vNorm1 = _mm512_setzero_ps();
+
+    // 16 samples a vector as in the SSE routine, so both correlate the same
+    // number of samples. Two vectors a round, and any odd one after.
+    const int numVectors = channels * overlapLength / 16;
+    for (i = 0; i + 2 <= numVectors; i += 2)
+    {
+        __m512 vTemp0 = _mm512_loadu_ps(pV1);
+        __m512 vTemp1 = _mm512_loadu_ps(pV1 + 16);
+
+        vSum0  = _mm512_fmadd_ps(vTemp0, _mm512_loadu_ps(pV2), vSum0);
+        vSum1  = _mm512_fmadd_ps(vTemp1, _mm512_loadu_ps(pV2 + 16), vSum1);
+        vNorm0 = _mm512_fmadd_ps(vTemp0, vTemp0, vNorm0);
+        vNorm1 = _mm512_fmadd_ps(vTemp1, vTemp1, vNorm1);
+
+        pV1 += 32;
+        pV2 += 32;
+    }
+    if (i < numVectors)
+    {
+        __m512 vTemp0 = _mm512_loadu_ps(pV1);
+
+        vSum0  = _mm512_fmadd_ps(vTemp0, _mm512_loadu_ps(pV2), vSum0);
+        vNorm0 = _mm512_fmadd_ps(vTemp0, vTemp0, vNorm0);
+    }
+
+    float norm = sumLanesAVX512(_mm512_add_ps(vNorm0, vNorm1));
+    anorm = norm;
+
+    return (double)sumLanesAVX512(_mm512_add_ps(vSum0, vSum1)) / sqrt(norm < 1e-9 ? 1.0 : norm);
+}
+
+#endif  // SOUNDTOUCH_ALLOW_AVX
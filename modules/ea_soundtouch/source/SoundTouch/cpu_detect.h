@@ -43,6 +43,8 @@
 #define SUPPORT_ALTIVEC     0x0004
 #define SUPPORT_SSE         0x0008
 #define SUPPORT_SSE2        0x0010
+#define SUPPORT_AVX2        0x0020      ///< AVX2 and FMA, and the OS saves YMM registers
+#define SUPPORT_AVX512      0x0040      ///< AVX-512F, and the OS saves ZMM registers
 
 /// Checks which instruction set extensions are supported by the CPU.
 ///
@@ -38,10 +38,10 @@
 
 #if defined(SOUNDTOUCH_ALLOW_X86_OPTIMIZATIONS)
 
-   #if defined(__GNUC__) && defined(__i386__)
+   #if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
        // gcc
        #include "cpuid.h"
-   #elif defined(_M_IX86)
+   #elif defined(_M_IX86) || defined(_M_X64)
        // windows non-gcc
        #include <intrin.h>
    #endif
@@ -68,16 +68,80 @@ void disableExtensions(uint dwDisableMask)
 }
 
 
+#if defined(SOUNDTOUCH_ALLOW_AVX)
+
+/// Checks for AVX2 & FMA and for AVX-512F. Having the instructions isn't enough: the
+/// OS must also save the wider registers on task switches, which XCR0 tells.
+static uint detectAVXextensions(void)
+{
+    uint leaf1[4];      // eax, ebx, ecx, edx
+    uint leaf7[4];
+    unsigned long long xcr0;
+
+#if defined(__GNUC__)
+    if (__get_cpuid_max(0, 0) < 7) return 0;
+    __cpuid(1, leaf1[0], leaf1[1], leaf1[2], leaf1[3]);
+    __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+#else
+    int reg[4];
+    __cpuid(reg, 0);
+    if (reg[0] < 7) return 0;
+    __cpuid(reg, 1);
+    for (int i = 0; i < 4; i ++) leaf1[i] = (uint)reg[i];
+    __cpuidex(reg, 7, 0);
+    for (int i = 0; i < 4; i ++) leaf7[i] = (uint)reg[i];
+#endif
+
+    const uint bitFMA = 1 << 12;        // leaf 1, ecx
+    const uint bitOSXSAVE = 1 << 27;    // leaf 1, ecx
+    const uint bitAVX = 1 << 28;        // leaf 1, ecx
+    const uint bitAVX2 = 1 << 5;        // leaf 7, ebx
+    const uint bitAVX512F = 1 << 16;    // leaf 7, ebx
+
+    if ((leaf1[2] & (bitOSXSAVE | bitAVX)) != (bitOSXSAVE | bitAVX)) return 0;
+
+#if defined(__GNUC__)
+    uint xcr0Low, xcr0High;
+    __asm__ __volatile__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+    xcr0 = ((unsigned long long)xcr0High << 32) | xcr0Low;
+#else
+    xcr0 = _xgetbv(0);
+#endif
+
+    uint res = 0;
+
+    // XMM & YMM state
+    if ((xcr0 & 0x06) == 0x06 && (leaf1[2] & bitFMA) && (leaf7[1] & bitAVX2))
+    {
+        res = res | SUPPORT_AVX2;
+
+        // opmask & ZMM state as well
+        if ((xcr0 & 0xe6) == 0xe6 && (leaf7[1] & bitAVX512F)) res = res | SUPPORT_AVX512;
+    }
+    return res;
+}
+
+#endif // SOUNDTOUCH_ALLOW_AVX
+
+
 /// Checks which instruction set extensions are supported by the CPU.
 uint detectCPUextensions(void)
 {
 /// If building for a 64bit system (no Itanium) and the user wants optimizations.
-/// Return the OR of SUPPORT_{MMX,SSE,SSE2}. 11001 or 0x19.
+/// Return the OR of SUPPORT_{MMX,SSE,SSE2}, 11001 or 0x19, which every x64 CPU
+/// has, and of whichever of SUPPORT_{AVX2,AVX512} this one has.
 /// Keep the _dwDisabledISA test (2 more operations, could be eliminated).
 #if ((defined(__GNUC__) && defined(__x86_64__)) \
     || defined(_M_X64))  \
     && defined(SOUNDTOUCH_ALLOW_X86_OPTIMIZATIONS)
+
+#if defined(SOUNDTOUCH_ALLOW_AVX)
+    // the cpuid instructions run once only
+    static const uint avxExtensions = detectAVXextensions();
+    return (0x19 | avxExtensions) & ~_dwDisabledISA;
+#else
     return 0x19 & ~_dwDisabledISA;
+#endif
 
 /// If building for a 32bit system and the user wants optimizations.
 /// Keep the _dwDisabledISA test (2 more operations, could be eliminated).
@@ -185,6 +185,62 @@ double TDStretchSSE::calcCrossCorrAccumulate(const float *pV1, const float *pV2,
 }
 
 
+//////////////////////////////////////////////////////////////////////////////
+//
+// implementation of SSE optimized functions of class 'BPMDetectSSE'
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "BPMDetect.h"
+
+BPMDetectSSE::BPMDetectSSE(int numChannels, int sampleRate) : BPMDetect(numChannels, sampleRate)
+{
+}
+
+
+// Correlates the windowed samples against the history at every lag
+void BPMDetectSSE::calcCorrelation(float *corr, const float *weighted, const float *history, int length)
+{
+    int offs;
+
+    // Works on 16 neighbouring lags at a time: each windowed sample is broadcast and
+    // multiplied with the history at all 16 lags at once, so each lane keeps the sum for
+    // one lag and no horizontal adds are needed. Sums are kept in single precision,
+    // which is plenty for the ~200 products per lag.
+    for (offs = windowStart; offs + 16 <= windowLen; offs += 16)
+    {
+        const float *pHistory = history + offs;
+        __m128 vSum0, vSum1, vSum2, vSum3;
+        vSum0 = vSum1 = vSum2 = vSum3 = _mm_setzero_ps();
+
+        for (int i = 0; i < length; i ++)
+        {
+            __m128 vWeight = _mm_set1_ps(weighted[i]);
+            vSum0 = _mm_add_ps(vSum0, _mm_mul_ps(vWeight, _mm_loadu_ps(pHistory + i)));
+            vSum1 = _mm_add_ps(vSum1, _mm_mul_ps(vWeight, _mm_loadu_ps(pHistory + i + 4)));
+            vSum2 = _mm_add_ps(vSum2, _mm_mul_ps(vWeight, _mm_loadu_ps(pHistory + i + 8)));
+            vSum3 = _mm_add_ps(vSum3, _mm_mul_ps(vWeight, _mm_loadu_ps(pHistory + i + 12)));
+        }
+
+        _mm_storeu_ps(corr + offs, vSum0);
+        _mm_storeu_ps(corr + offs + 4, vSum1);
+        _mm_storeu_ps(corr + offs + 8, vSum2);
+        _mm_storeu_ps(corr + offs + 12, vSum3);
+    }
+
+    // the last few lags one at a time
+    for (; offs < windowLen; offs ++)
+    {
+        float sum = 0;
+        for (int i = 0; i < length; i ++)
+        {
+            sum += weighted[i] * history[i + offs];
+        }
+        corr[offs] = sum;
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // implementation of SSE optimized functions of class 'FIRFilter'